@@ -0,0 +1,513 @@
+#include "REDumpCore.h"
+
+#include <cstdlib>
+
+namespace REDumpCore
+{
+  namespace
+  {
+    inline bool IsSpace(char Ch)
+    {
+      return Ch == ' ' || Ch == '\t' || Ch == '\r' || Ch == '\n' || Ch == '\v' || Ch == '\f';
+    }
+
+    inline char ToLower(char Ch)
+    {
+      return Ch >= 'A' && Ch <= 'Z' ? Ch + ('a' - 'A') : Ch;
+    }
+
+    inline bool StartsWithChar(std::string_view Str, char Ch)
+    {
+      return Str.size() && Str.front() == Ch;
+    }
+
+    // strto* need a null terminated string. Numbers are short, so use a stack buffer.
+    template <typename TFunc>
+    inline auto ConvertView(std::string_view Str, TFunc Func)
+    {
+      char Buffer[64];
+      const size_t Len = Str.size() < sizeof(Buffer) - 1 ? Str.size() : sizeof(Buffer) - 1;
+      for (size_t Idx = 0; Idx < Len; ++Idx)
+      {
+        Buffer[Idx] = Str[Idx];
+      }
+      Buffer[Len] = 0;
+      return Func(Buffer);
+    }
+
+    // Parse a material starting at Lines[Idx]. Modifies Idx. Returns false on error.
+    bool ReadMaterial(const std::vector<std::string_view>& Lines, size_t& Idx, MaterialEntry& Material)
+    {
+      const std::string_view Line = Lines[Idx];
+      if (Line.empty())
+      {
+        return false;
+      }
+
+      Tokenizer Header(Line, ' ');
+      std::string_view ClassView;
+      std::string_view ParentView;
+      if (!Header.Next(ClassView) || !Header.HasMore())
+      {
+        return false;
+      }
+
+      Material.Class = ClassView;
+      if (!Equals(ClassView, "Material"))
+      {
+        if (!Header.Next(ParentView) || !Header.HasMore())
+        {
+          return false;
+        }
+        Material.ParentName = ParentView;
+      }
+      Material.Name = Header.Rest();
+
+      while (++Idx < Lines.size())
+      {
+        const std::string_view Raw = Lines[Idx];
+        if (!StartsWithChar(Raw, ' '))
+        {
+          break;
+        }
+        const std::string_view Trimmed = Trim(Raw);
+        if (Equals(Trimmed, "TwoSided"))
+        {
+          Material.TwoSided = true;
+          continue;
+        }
+
+        Tokenizer Tokens(Trimmed);
+        std::string_view Type;
+        MaterialParameter Parameter;
+        if (!Tokens.Next(Type) || !Tokens.HasMore() || !Tokens.Next(Parameter.Name) || !Tokens.HasMore())
+        {
+          break;
+        }
+
+        if (Equals(Type, "Texture"))
+        {
+          Parameter.Type = EParameterType::Texture;
+          Parameter.Texture = Tokens.Rest();
+        }
+        else if (Equals(Type, "TextureA"))
+        {
+          Parameter.Type = EParameterType::TextureA;
+          Parameter.Texture = Tokens.Rest();
+        }
+        else if (Equals(Type, "Scalar"))
+        {
+          Parameter.Type = EParameterType::Scalar;
+          Parameter.Value[0] = ToFloat(Tokens.Rest());
+        }
+        else if (Equals(Type, "Bool"))
+        {
+          Parameter.Type = EParameterType::Bool;
+          Parameter.Bool = ToBool(Tokens.Rest());
+        }
+        else if (Equals(Type, "Vector"))
+        {
+          std::string_view R, G, B;
+          if (!Tokens.Next(R) || !Tokens.HasMore() || !Tokens.Next(G) || !Tokens.HasMore() || !Tokens.Next(B) || !Tokens.HasMore())
+          {
+            break;
+          }
+          Parameter.Type = EParameterType::Vector;
+          Parameter.Value[0] = ToFloat(R);
+          Parameter.Value[1] = ToFloat(G);
+          Parameter.Value[2] = ToFloat(B);
+          Parameter.Value[3] = ToFloat(Tokens.Rest());
+        }
+        else
+        {
+          continue;
+        }
+        Material.Parameters.push_back(Parameter);
+      }
+      Idx--;
+      return true;
+    }
+
+    bool ReadTexture(std::string_view Line, TextureEntry& Texture)
+    {
+      Tokenizer Tokens(Line);
+      std::string_view CompressionView, SRGBView, IsDXTView, NameView;
+      if (!Tokens.Next(CompressionView) || !Tokens.HasMore() ||
+          !Tokens.Next(SRGBView) || !Tokens.HasMore() ||
+          !Tokens.Next(IsDXTView) || !Tokens.HasMore() ||
+          !Tokens.Next(NameView) || !Tokens.HasMore())
+      {
+        return false;
+      }
+      const std::string_view SourceView = Tokens.Rest();
+      if (NameView.empty() || SourceView.empty())
+      {
+        return false;
+      }
+      Texture.Compression = CompressionView;
+      Texture.SRGB = ToBool(SRGBView);
+      Texture.IsDXT = ToBool(IsDXTView);
+      Texture.Name = NameView;
+      Texture.Source = SourceView;
+      return true;
+    }
+
+    // "Key=Value". Returns false if there is no '='.
+    bool SplitProperty(std::string_view Line, CueProperty& OutProperty)
+    {
+      const size_t Pos = Line.find('=');
+      if (Pos == std::string_view::npos)
+      {
+        return false;
+      }
+      OutProperty.Key = Line.substr(0, Pos);
+      OutProperty.Value = Line.substr(Pos + 1);
+      return true;
+    }
+
+    // "Index<VSEP>Class" node header
+    bool ReadCueNodeHeader(std::string_view Line, CueNode& OutNode)
+    {
+      Tokenizer Tokens(Line);
+      std::string_view IndexView;
+      if (!Tokens.Next(IndexView) || !Tokens.HasMore())
+      {
+        return false;
+      }
+      OutNode.Index = ToInt(IndexView);
+      OutNode.Class = Tokens.Rest();
+      return true;
+    }
+  }
+
+  bool Tokenizer::Next(std::string_view& OutField)
+  {
+    if (Pos > Line.size())
+    {
+      return false;
+    }
+    const char* Begin = Line.data() + Pos;
+    const char* End = Line.data() + Line.size();
+    const char* Sep = FindChar(Begin, End, Separator);
+    OutField = std::string_view(Begin, (size_t)(Sep - Begin));
+    Pos += OutField.size() + 1;
+    return true;
+  }
+
+  bool Equals(std::string_view A, std::string_view B)
+  {
+    if (A.size() != B.size())
+    {
+      return false;
+    }
+    for (size_t Idx = 0; Idx < A.size(); ++Idx)
+    {
+      if (ToLower(A[Idx]) != ToLower(B[Idx]))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool StartsWith(std::string_view Str, std::string_view Prefix)
+  {
+    return Str.size() >= Prefix.size() && Equals(Str.substr(0, Prefix.size()), Prefix);
+  }
+
+  std::string_view Trim(std::string_view Str)
+  {
+    size_t Begin = 0;
+    size_t End = Str.size();
+    while (Begin < End && IsSpace(Str[Begin]))
+    {
+      Begin++;
+    }
+    while (End > Begin && IsSpace(Str[End - 1]))
+    {
+      End--;
+    }
+    return Str.substr(Begin, End - Begin);
+  }
+
+  float ToFloat(std::string_view Str)
+  {
+    return ConvertView(Str, [](const char* Buffer) { return (float)std::strtod(Buffer, nullptr); });
+  }
+
+  int32_t ToInt(std::string_view Str)
+  {
+    return ConvertView(Str, [](const char* Buffer) { return (int32_t)std::strtol(Buffer, nullptr, 10); });
+  }
+
+  bool ToBool(std::string_view Str)
+  {
+    if (Equals(Str, "True") || Equals(Str, "Yes") || Equals(Str, "On"))
+    {
+      return true;
+    }
+    if (Equals(Str, "False") || Equals(Str, "No") || Equals(Str, "Off"))
+    {
+      return false;
+    }
+    return ToInt(Str) != 0;
+  }
+
+  size_t ParseMaterials(std::string_view Text, std::vector<MaterialEntry>& OutEntries, std::vector<size_t>& OutErrorLines)
+  {
+    std::vector<std::string_view> Lines;
+    SplitLines(Text, Lines);
+    for (size_t Idx = 0; Idx < Lines.size(); ++Idx)
+    {
+      if (StartsWithChar(Lines[Idx], ' '))
+      {
+        // If ReadMaterial failed Idx may not be correct. Find next entry
+        continue;
+      }
+
+      MaterialEntry Material;
+      const size_t StartIdx = Idx;
+      if (!ReadMaterial(Lines, Idx, Material))
+      {
+        OutErrorLines.push_back(StartIdx);
+        continue;
+      }
+      OutEntries.push_back(std::move(Material));
+    }
+    return Lines.size();
+  }
+
+  size_t ParseTextures(std::string_view Text, std::vector<TextureEntry>& OutEntries, std::vector<size_t>& OutErrorLines)
+  {
+    std::vector<std::string_view> Lines;
+    SplitLines(Text, Lines);
+    OutEntries.reserve(OutEntries.size() + Lines.size());
+    for (size_t Idx = 0; Idx < Lines.size(); ++Idx)
+    {
+      TextureEntry Texture;
+      if (!ReadTexture(Lines[Idx], Texture))
+      {
+        OutErrorLines.push_back(Idx);
+        continue;
+      }
+      OutEntries.push_back(Texture);
+    }
+    return Lines.size();
+  }
+
+  size_t ParseDefaultMaterials(std::string_view Text, std::vector<DefaultMaterialsEntry>& OutEntries, std::vector<size_t>& OutErrorLines)
+  {
+    std::vector<std::string_view> Lines;
+    SplitLines(Text, Lines);
+    for (size_t Idx = 0; Idx < Lines.size(); ++Idx)
+    {
+      // A slot without a mesh
+      if (StartsWithChar(Lines[Idx], ' '))
+      {
+        OutErrorLines.push_back(Idx);
+        continue;
+      }
+      DefaultMaterialsEntry Entry;
+      Entry.Name = Lines[Idx];
+      while (++Idx < Lines.size() && StartsWithChar(Lines[Idx], ' '))
+      {
+        const std::string_view Material = Trim(Lines[Idx]);
+        if (Material.empty())
+        {
+          // Slots are positional. Keep the entry, but don't pretend the dump is fine.
+          OutErrorLines.push_back(Idx);
+        }
+        Entry.Materials.push_back(Material);
+      }
+      Idx--;
+      OutEntries.push_back(std::move(Entry));
+    }
+    return Lines.size();
+  }
+
+  size_t ParseSpeedTreeOverrides(std::string_view Text, std::vector<SpeedTreeOverrideEntry>& OutEntries, std::vector<size_t>& OutErrorLines)
+  {
+    std::vector<std::string_view> Lines;
+    SplitLines(Text, Lines);
+    for (size_t Idx = 0; Idx < Lines.size(); ++Idx)
+    {
+      // An override without an actor
+      if (StartsWithChar(Lines[Idx], ' '))
+      {
+        OutErrorLines.push_back(Idx);
+        continue;
+      }
+      SpeedTreeOverrideEntry Entry;
+      Entry.ActorName = Lines[Idx];
+      while (++Idx < Lines.size() && StartsWithChar(Lines[Idx], ' '))
+      {
+        Tokenizer Tokens(Trim(Lines[Idx]));
+        MaterialOverride Override;
+        if (!Tokens.Next(Override.Slot) || !Tokens.HasMore())
+        {
+          OutErrorLines.push_back(Idx);
+          continue;
+        }
+        Override.Material = Tokens.Rest();
+        Entry.Overrides.push_back(Override);
+      }
+      Idx--;
+      OutEntries.push_back(std::move(Entry));
+    }
+    return Lines.size();
+  }
+
+  bool ParseCue(std::string_view Text, CueEntry& OutCue, const char*& OutError)
+  {
+    std::vector<std::string_view> Lines;
+    SplitLines(SkipBom(Text), Lines);
+
+    // The first meaningful line is the in-game path
+    for (std::string_view Line : Lines)
+    {
+      if (Line.size() >= 2)
+      {
+        OutCue.Path = Line;
+        break;
+      }
+    }
+    if (OutCue.Path.empty())
+    {
+      OutError = "The file has no in-game path!";
+      return false;
+    }
+
+    // Cue properties, then "Nodes:" and node headers followed by tab indented node properties.
+    // Node headers may appear before "Nodes:" too.
+    bool bInNodes = false;
+    CueNode* Node = nullptr;
+    for (size_t Idx = 1; Idx < Lines.size(); ++Idx)
+    {
+      const std::string_view Line = Lines[Idx];
+      if (Line.size() <= 2)
+      {
+        continue;
+      }
+      if (!bInNodes)
+      {
+        if (StartsWithChar(Line, '\t') || StartsWithChar(Line, ' '))
+        {
+          continue;
+        }
+        CueProperty Property;
+        if (SplitProperty(Line, Property))
+        {
+          if (Equals(Property.Key, "Volume"))
+          {
+            OutCue.Volume = ToFloat(Property.Value);
+            continue;
+          }
+          if (Equals(Property.Key, "Pitch"))
+          {
+            OutCue.Pitch = ToFloat(Property.Value);
+            continue;
+          }
+          if (Equals(Property.Key, "MaxConcurrentPlayCount"))
+          {
+            OutCue.MaxConcurrentPlayCount = ToInt(Property.Value);
+            continue;
+          }
+        }
+      }
+      if (StartsWith(Line, "Nodes:"))
+      {
+        if (bInNodes)
+        {
+          OutError = "Unexpected \"Nodes\" tag!";
+          return false;
+        }
+        bInNodes = true;
+        continue;
+      }
+
+      if (StartsWithChar(Line, '\t'))
+      {
+        if (!Node || !bInNodes)
+        {
+          continue;
+        }
+        const std::string_view Formatted = Line.substr(1);
+        CueProperty Property;
+        if (!SplitProperty(Formatted, Property))
+        {
+          Property.Key = Formatted;
+        }
+        if (Equals(Property.Key, "Children"))
+        {
+          Node->Children = ParseCueChildren(Property.Value);
+        }
+        else
+        {
+          Node->Properties.push_back(Property);
+        }
+        continue;
+      }
+
+      CueNode NewNode;
+      if (!ReadCueNodeHeader(Line, NewNode))
+      {
+        Node = nullptr;
+        continue;
+      }
+      OutCue.Nodes.push_back(NewNode);
+      Node = &OutCue.Nodes.back();
+    }
+
+    if (!bInNodes || OutCue.Nodes.empty())
+    {
+      OutError = "Failed to find a root node!";
+      return false;
+    }
+    return true;
+  }
+
+  CueChildren ParseCueChildren(std::string_view Value)
+  {
+    // ((Index=1,Weight=0.5),(Index=2,Weight=0.5))
+    CueChildren Result;
+    size_t Pos = 0;
+    while ((Pos = Value.find('(', Pos)) != std::string_view::npos)
+    {
+      const size_t ItemEnd = Value.find(')', Pos);
+      std::string_view Item = Value.substr(Pos + 1, ItemEnd == std::string_view::npos ? std::string_view::npos : ItemEnd - Pos - 1);
+      Pos = ItemEnd == std::string_view::npos ? Value.size() : ItemEnd + 1;
+      if (StartsWithChar(Item, '('))
+      {
+        // Opening of the list
+        Item.remove_prefix(1);
+      }
+      Tokenizer Fields(Item, ',');
+      std::string_view Field;
+      while (Fields.Next(Field))
+      {
+        CueProperty Property;
+        if (!SplitProperty(Field, Property))
+        {
+          continue;
+        }
+        if (Equals(Property.Key, "Index"))
+        {
+          Result.Indices.push_back(ToInt(Property.Value));
+        }
+        else if (Equals(Property.Key, "Weight"))
+        {
+          Result.Weights.push_back(ToFloat(Property.Value));
+        }
+        else if (Equals(Property.Key, "Volume"))
+        {
+          Result.Volumes.push_back(ToFloat(Property.Value));
+        }
+        else if (Equals(Property.Key, "Pitch"))
+        {
+          Result.Pitches.push_back(ToFloat(Property.Value));
+        }
+      }
+    }
+    return Result;
+  }
+}
@@ -0,0 +1,202 @@
+#pragma once
+// Engine independent RE dump parsers. Plain C++17, no UE types, so the code
+// can be built and profiled outside the editor (see Tools/REDumpCore).
+// Parsed entries are views into the source text. Keep the text alive while using them.
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace REDumpCore
+{
+  // Value separator in RE dumps. Must match RE implementation.
+  constexpr char VSEP_CHAR = '\t';
+
+  // Byte scanner. Uses SSE2 on x86 and AVX2 when the CPU supports it. The CPU is checked at startup.
+
+  enum class EInstructionSet {
+    Scalar,
+    SSE2,
+    AVX2
+  };
+
+  // First Ch in [Begin, End). Returns End if there is none.
+  const char* FindChar(const char* Begin, const char* End, char Ch);
+  // Start of the first line after Begin that doesn't begin with a space, i.e. the next top level dump entry. Returns End if there is none.
+  const char* FindEntryStart(const char* Begin, const char* End);
+  // Start of the last line in (Begin, End) that doesn't begin with a space. Returns Begin if there is none.
+  const char* FindLastEntryStart(const char* Begin, const char* End);
+  // Split text to lines without line terminators
+  void SplitLines(std::string_view Text, std::vector<std::string_view>& OutLines, bool bCullEmpty = true);
+  // Call OnLine(Begin, Length) for each line in [Begin, End) without line terminators
+  template <typename TOnLine>
+  void ForEachLine(const char* Begin, const char* End, bool bCullEmpty, TOnLine&& OnLine)
+  {
+    const char* Ptr = Begin;
+    while (Ptr < End)
+    {
+      const char* Eol = FindChar(Ptr, End, '\n');
+      const char* LineEnd = (Eol > Ptr && Eol[-1] == '\r') ? Eol - 1 : Eol;
+      if (LineEnd > Ptr || !bCullEmpty)
+      {
+        OnLine(Ptr, (size_t)(LineEnd - Ptr));
+      }
+      Ptr = Eol + 1;
+    }
+  }
+  // Strip UTF-8 BOM
+  std::string_view SkipBom(std::string_view Text);
+
+  // Instruction set in use
+  EInstructionSet GetInstructionSet();
+  const char* GetInstructionSetName();
+  // Best instruction set of this CPU
+  EInstructionSet GetSupportedInstructionSet();
+  // Use a lower instruction set. Returns false if the CPU doesn't support Set. Used by tests and benchmarks.
+  bool SetInstructionSet(EInstructionSet Set);
+  // Disable vector code. Used to benchmark the scalar fallback.
+  void SetForceScalar(bool bForce);
+
+  // Splits a dump line into fields without copying. Returned views point into the source line.
+  class Tokenizer {
+  public:
+    Tokenizer(std::string_view InLine, char InSeparator = VSEP_CHAR)
+      : Line(InLine)
+      , Separator(InSeparator)
+    {}
+
+    // Get the next field. Returns false if the line is exhausted.
+    bool Next(std::string_view& OutField);
+
+    // True if the last field was terminated by a separator
+    bool HasMore() const
+    {
+      return Pos <= Line.size();
+    }
+
+    // Everything after the last consumed separator, including any further separators
+    std::string_view Rest() const
+    {
+      return Pos <= Line.size() ? Line.substr(Pos) : std::string_view();
+    }
+
+  private:
+    std::string_view Line;
+    char Separator = VSEP_CHAR;
+    size_t Pos = 0;
+  };
+
+  // Case insensitive ASCII comparison. RE writes keywords in a fixed case, but UE parsers never relied on it.
+  bool Equals(std::string_view A, std::string_view B);
+  bool StartsWith(std::string_view Str, std::string_view Prefix);
+  std::string_view Trim(std::string_view Str);
+  float ToFloat(std::string_view Str);
+  int32_t ToInt(std::string_view Str);
+  // Same rules as FCString::ToBool
+  bool ToBool(std::string_view Str);
+
+  enum class EParameterType : uint8_t {
+    Bool,
+    Scalar,
+    Texture,
+    // Texture with an alpha channel. The alpha goes to "<Name>_Alpha" parameter.
+    TextureA,
+    Vector
+  };
+
+  struct MaterialParameter {
+    EParameterType Type = EParameterType::Scalar;
+    std::string_view Name;
+    // Texture and TextureA
+    std::string_view Texture;
+    // Scalar uses Value[0]. Vector is RGBA.
+    float Value[4] = {};
+    bool Bool = false;
+  };
+
+  // MaterialsList.txt entry
+  struct MaterialEntry {
+    std::string_view Name;
+    std::string_view Class;
+    // Empty for "Material" entries
+    std::string_view ParentName;
+    std::vector<MaterialParameter> Parameters;
+    bool TwoSided = false;
+  };
+
+  // Textures.txt entry
+  struct TextureEntry {
+    std::string_view Name;
+    std::string_view Compression;
+    std::string_view Source;
+    bool SRGB = false;
+    bool IsDXT = false;
+  };
+
+  // DefaultMaterials.txt entry. A mesh and its material slots.
+  struct DefaultMaterialsEntry {
+    std::string_view Name;
+    // Material per slot. "None" for empty slots.
+    std::vector<std::string_view> Materials;
+  };
+
+  // SpeedTreeOverrides.txt material override
+  struct MaterialOverride {
+    // Suffix of the slot name
+    std::string_view Slot;
+    // "None" to clear the slot
+    std::string_view Material;
+  };
+
+  // SpeedTreeOverrides.txt entry. An actor and its material overrides.
+  struct SpeedTreeOverrideEntry {
+    std::string_view ActorName;
+    std::vector<MaterialOverride> Overrides;
+  };
+
+  // Dump parsers. Text must start at a top level entry. Malformed entries are skipped and
+  // their line numbers (zero based, relative to Text) are added to OutErrorLines.
+  // Each parser returns the number of non empty lines in Text.
+  size_t ParseMaterials(std::string_view Text, std::vector<MaterialEntry>& OutEntries, std::vector<size_t>& OutErrorLines);
+  size_t ParseTextures(std::string_view Text, std::vector<TextureEntry>& OutEntries, std::vector<size_t>& OutErrorLines);
+  size_t ParseDefaultMaterials(std::string_view Text, std::vector<DefaultMaterialsEntry>& OutEntries, std::vector<size_t>& OutErrorLines);
+  size_t ParseSpeedTreeOverrides(std::string_view Text, std::vector<SpeedTreeOverrideEntry>& OutEntries, std::vector<size_t>& OutErrorLines);
+
+  // Node property of a *.cue file. Key=Value.
+  struct CueProperty {
+    std::string_view Key;
+    std::string_view Value;
+  };
+
+  // Children=((Index=N,Weight=W,...),...) property of a cue node
+  struct CueChildren {
+    std::vector<int32_t> Indices;
+    std::vector<float> Weights;
+    std::vector<float> Volumes;
+    std::vector<float> Pitches;
+  };
+
+  struct CueNode {
+    int32_t Index = -1;
+    std::string_view Class;
+    // Everything but Children in the file order
+    std::vector<CueProperty> Properties;
+    std::optional<CueChildren> Children;
+  };
+
+  // *.cue file. The first node is the root.
+  struct CueEntry {
+    // In-game path of the cue
+    std::string_view Path;
+    std::optional<float> Volume;
+    std::optional<float> Pitch;
+    std::optional<int32_t> MaxConcurrentPlayCount;
+    std::vector<CueNode> Nodes;
+  };
+
+  // Parse a *.cue file. Returns false and sets OutError if the file is malformed.
+  bool ParseCue(std::string_view Text, CueEntry& OutCue, const char*& OutError);
+  // Parse a Children property value
+  CueChildren ParseCueChildren(std::string_view Value);
+}
@@ -0,0 +1,246 @@
+#include "REDumpCore.h"
+
+// SSE2 is part of x64. AVX2 is compiled with a target attribute and picked at runtime, so builds for
+// older CPUs (like the editor's) still use it where the CPU has it.
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#define RE_SCANNER_SSE2 1
+#if defined(__GNUC__) || defined(__clang__)
+#define RE_SCANNER_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define RE_SCANNER_TARGET_AVX2
+#endif
+#endif
+
+#ifndef RE_SCANNER_SSE2
+#define RE_SCANNER_SSE2 0
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace REDumpCore
+{
+  namespace
+  {
+    inline uint32_t CountTrailingZeros(uint32_t Value)
+    {
+#if defined(_MSC_VER)
+      unsigned long Result = 0;
+      _BitScanForward(&Result, Value);
+      return (uint32_t)Result;
+#else
+      return (uint32_t)__builtin_ctz(Value);
+#endif
+    }
+
+    EInstructionSet DetectInstructionSet()
+    {
+#if RE_SCANNER_SSE2
+#if defined(_MSC_VER) && !defined(__clang__)
+      int Info[4] = {};
+      __cpuid(Info, 0);
+      if (Info[0] < 7)
+      {
+        return EInstructionSet::SSE2;
+      }
+      // The OS must save YMM registers too
+      __cpuid(Info, 1);
+      const bool bAvx = (Info[2] & (1 << 27)) && (Info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+      __cpuidex(Info, 7, 0);
+      return bAvx && (Info[1] & (1 << 5)) ? EInstructionSet::AVX2 : EInstructionSet::SSE2;
+#else
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2") ? EInstructionSet::AVX2 : EInstructionSet::SSE2;
+#endif
+#else
+      return EInstructionSet::Scalar;
+#endif
+    }
+
+    const EInstructionSet SupportedSet = DetectInstructionSet();
+    EInstructionSet ActiveSet = SupportedSet;
+
+#if RE_SCANNER_SSE2
+    // The vector functions scan whole blocks from Ptr. They return the match or advance Ptr to the tail and return null.
+    const char* FindCharSSE2(const char*& Ptr, const char* End, char Ch)
+    {
+      const __m128i Pattern = _mm_set1_epi8(Ch);
+      for (; End - Ptr >= 16; Ptr += 16)
+      {
+        if (const uint32_t Mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)Ptr), Pattern)))
+        {
+          return Ptr + CountTrailingZeros(Mask);
+        }
+      }
+      return nullptr;
+    }
+
+    RE_SCANNER_TARGET_AVX2 const char* FindCharAVX2(const char*& Ptr, const char* End, char Ch)
+    {
+      const __m256i Pattern = _mm256_set1_epi8(Ch);
+      for (; End - Ptr >= 32; Ptr += 32)
+      {
+        if (const uint32_t Mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)Ptr), Pattern)))
+        {
+          return Ptr + CountTrailingZeros(Mask);
+        }
+      }
+      return nullptr;
+    }
+
+    // A line feed at N followed by anything but a space at N + 1
+    const char* FindEntryStartSSE2(const char*& Ptr, const char* End)
+    {
+      const __m128i NewLine = _mm_set1_epi8('\n');
+      const __m128i Space = _mm_set1_epi8(' ');
+      for (; End - Ptr > 16; Ptr += 16)
+      {
+        const uint32_t NewLines = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)Ptr), NewLine));
+        const uint32_t Spaces = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(Ptr + 1)), Space));
+        if (const uint32_t Mask = NewLines & ~Spaces)
+        {
+          return Ptr + CountTrailingZeros(Mask) + 1;
+        }
+      }
+      return nullptr;
+    }
+
+    RE_SCANNER_TARGET_AVX2 const char* FindEntryStartAVX2(const char*& Ptr, const char* End)
+    {
+      const __m256i NewLine = _mm256_set1_epi8('\n');
+      const __m256i Space = _mm256_set1_epi8(' ');
+      for (; End - Ptr > 32; Ptr += 32)
+      {
+        const uint32_t NewLines = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)Ptr), NewLine));
+        const uint32_t Spaces = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(Ptr + 1)), Space));
+        if (const uint32_t Mask = NewLines & ~Spaces)
+        {
+          return Ptr + CountTrailingZeros(Mask) + 1;
+        }
+      }
+      return nullptr;
+    }
+#endif
+  }
+
+  const char* FindChar(const char* Begin, const char* End, char Ch)
+  {
+    const char* Ptr = Begin;
+#if RE_SCANNER_SSE2
+    const char* Found = nullptr;
+    if (ActiveSet == EInstructionSet::AVX2)
+    {
+      Found = FindCharAVX2(Ptr, End, Ch);
+    }
+    else if (ActiveSet == EInstructionSet::SSE2)
+    {
+      Found = FindCharSSE2(Ptr, End, Ch);
+    }
+    if (Found)
+    {
+      return Found;
+    }
+#endif
+    for (; Ptr < End; ++Ptr)
+    {
+      if (*Ptr == Ch)
+      {
+        return Ptr;
+      }
+    }
+    return End;
+  }
+
+  const char* FindEntryStart(const char* Begin, const char* End)
+  {
+    const char* Ptr = Begin;
+#if RE_SCANNER_SSE2
+    const char* Found = nullptr;
+    if (ActiveSet == EInstructionSet::AVX2)
+    {
+      Found = FindEntryStartAVX2(Ptr, End);
+    }
+    else if (ActiveSet == EInstructionSet::SSE2)
+    {
+      Found = FindEntryStartSSE2(Ptr, End);
+    }
+    if (Found)
+    {
+      return Found;
+    }
+#endif
+    for (; Ptr + 1 < End; ++Ptr)
+    {
+      if (Ptr[0] == '\n' && Ptr[1] != ' ')
+      {
+        return Ptr + 1;
+      }
+    }
+    return End;
+  }
+
+  const char* FindLastEntryStart(const char* Begin, const char* End)
+  {
+    // Entries are short. A backward scalar search stops long before a vector one would pay off.
+    for (const char* Ptr = End - 1; Ptr > Begin; --Ptr)
+    {
+      if (Ptr[-1] == '\n' && *Ptr != ' ')
+      {
+        return Ptr;
+      }
+    }
+    return Begin;
+  }
+
+  void SplitLines(std::string_view Text, std::vector<std::string_view>& OutLines, bool bCullEmpty)
+  {
+    ForEachLine(Text.data(), Text.data() + Text.size(), bCullEmpty, [&](const char* Line, size_t Len) {
+      OutLines.emplace_back(Line, Len);
+    });
+  }
+
+  std::string_view SkipBom(std::string_view Text)
+  {
+    return Text.size() >= 3 && Text.compare(0, 3, "\xEF\xBB\xBF") == 0 ? Text.substr(3) : Text;
+  }
+
+  EInstructionSet GetInstructionSet()
+  {
+    return ActiveSet;
+  }
+
+  EInstructionSet GetSupportedInstructionSet()
+  {
+    return SupportedSet;
+  }
+
+  const char* GetInstructionSetName()
+  {
+    switch (GetInstructionSet())
+    {
+    case EInstructionSet::AVX2:
+      return "AVX2";
+    case EInstructionSet::SSE2:
+      return "SSE2";
+    default:
+      return "Scalar";
+    }
+  }
+
+  bool SetInstructionSet(EInstructionSet Set)
+  {
+    if (Set > SupportedSet)
+    {
+      return false;
+    }
+    ActiveSet = Set;
+    return true;
+  }
+
+  void SetForceScalar(bool bForce)
+  {
+    ActiveSet = bForce ? EInstructionSet::Scalar : SupportedSet;
+  }
+}
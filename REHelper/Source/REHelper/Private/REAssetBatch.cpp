@@ -0,0 +1,147 @@
+#include "REAssetBatch.h"
+#include "REImportBatch.h"
+#include "REResolver.h"
+
+#include "AssetRegistryModule.h"
+#include "AssetToolsModule.h"
+#include "Factories/Factory.h"
+#include "HAL/IConsoleManager.h"
+#include "IAssetTools.h"
+#include "Misc/BlacklistNames.h"
+#include "Misc/PackageName.h"
+#include "PackageTools.h"
+
+namespace
+{
+  TAutoConsoleVariable<int32> CVarAssetBatch(
+    TEXT("REHelper.AssetBatch"),
+    1,
+    TEXT("Create import assets in batches and notify the asset registry once per batch."));
+
+  int32 BatchDepth = 0;
+  // Created during the batch and not yet announced to the registry
+  TArray<TWeakObjectPtr<UObject>> PendingAssets;
+  // Package names taken by this batch
+  TSet<FString> ReservedNames;
+
+  IAssetTools& GetAssetTools()
+  {
+    return FModuleManager::Get().LoadModuleChecked<FAssetToolsModule>("AssetTools").Get();
+  }
+
+  // Take the path as is if the index knows it's free. Ask AssetTools otherwise.
+  void ReserveName(const FString& Path, FString& OutPackageName, FString& OutAssetName)
+  {
+    if (!ReservedNames.Contains(Path) && !FindPackage(nullptr, *Path) && REResolver::GetIndexState(Path, UObject::StaticClass()) == REResolver::EIndexState::Missing)
+    {
+      OutPackageName = Path;
+      OutAssetName = FPackageName::GetShortName(Path);
+    }
+    else
+    {
+      GetAssetTools().CreateUniqueAssetName(Path, TEXT(""), OutPackageName, OutAssetName);
+    }
+    ReservedNames.Add(OutPackageName);
+  }
+
+  // The checks AssetTools runs before it creates an asset
+  bool CanCreateAsset(const FString& PackageName, const FString& AssetName)
+  {
+    FText Reason;
+    if (!FPackageName::IsValidLongPackageName(PackageName, false, &Reason) || !FName(*AssetName).IsValidObjectName(Reason))
+    {
+      UE_LOG(LogTemp, Error, TEXT("RE Helper: Can't create %s: %s"), *PackageName, *Reason.ToString());
+      return false;
+    }
+    if (!GetAssetTools().GetWritableFolderBlacklist()->PassesStartsWithFilter(FPackageName::GetLongPackagePath(PackageName)))
+    {
+      UE_LOG(LogTemp, Error, TEXT("RE Helper: Can't create %s: the folder is read only"), *PackageName);
+      return false;
+    }
+    UPackage* Existing = FindPackage(nullptr, *PackageName);
+    if (Existing && FindObject<UObject>(Existing, *AssetName))
+    {
+      UE_LOG(LogTemp, Error, TEXT("RE Helper: Can't create %s: an object with this name exists already"), *PackageName);
+      return false;
+    }
+    return true;
+  }
+}
+
+UObject* REAssetBatch::CreateAsset(const FString& Path, UClass* Class, UFactory* Factory)
+{
+  // Both paths must agree on names, otherwise the index and AssetTools would pick different packages for the same path
+  const FString Normalized = UPackageTools::SanitizePackageName(REResolver::NormalizePath(Path));
+  if (!IsActive())
+  {
+    FString PackageName;
+    FString AssetName;
+    IAssetTools& AssetTools = GetAssetTools();
+    AssetTools.CreateUniqueAssetName(Normalized, TEXT(""), PackageName, AssetName);
+    UObject* Asset = AssetTools.CreateAsset(AssetName, FPackageName::GetLongPackagePath(PackageName), Class, Factory);
+    if (Asset)
+    {
+      FAssetRegistryModule::AssetCreated(Asset);
+      REResolver::OnAssetCreated(Asset);
+      REImportBatch::OnAssetCreated(Asset);
+    }
+    return Asset;
+  }
+
+  FString PackageName;
+  FString AssetName;
+  ReserveName(Normalized, PackageName, AssetName);
+  if (!CanCreateAsset(PackageName, AssetName))
+  {
+    return nullptr;
+  }
+  UPackage* Package = CreatePackage(*PackageName);
+  UObject* Asset = Factory->FactoryCreateNew(Class, Package, FName(*AssetName), RF_Public | RF_Standalone | RF_Transactional, nullptr, GWarn);
+  if (!Asset)
+  {
+    return nullptr;
+  }
+  Package->MarkPackageDirty();
+  PendingAssets.Add(Asset);
+  REResolver::OnAssetCreated(Asset);
+  REImportBatch::OnAssetCreated(Asset);
+  return Asset;
+}
+
+bool REAssetBatch::IsActive()
+{
+  return BatchDepth > 0 && CVarAssetBatch.GetValueOnGameThread();
+}
+
+void REAssetBatch::Begin()
+{
+  BatchDepth++;
+}
+
+void REAssetBatch::End()
+{
+  if (--BatchDepth)
+  {
+    return;
+  }
+  FlushPending();
+  ReservedNames.Empty();
+}
+
+void REAssetBatch::FlushPending()
+{
+  int32 NumAssets = 0;
+  for (const TWeakObjectPtr<UObject>& Asset : PendingAssets)
+  {
+    if (UObject* Object = Asset.Get())
+    {
+      FAssetRegistryModule::AssetCreated(Object);
+      NumAssets++;
+    }
+  }
+  if (NumAssets)
+  {
+    UE_LOG(LogTemp, Display, TEXT("RE Helper: Registered %d new assets"), NumAssets);
+  }
+  PendingAssets.Empty();
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "CoreMinimal.h"
+
+class UFactory;
+
+// Creates assets for imports. While an FScopedAssetBatch is alive, names are reserved against the resolver index
+// instead of querying AssetTools for every asset. Names are sanitized and checked the way AssetTools does it.
+// Registry notifications are held back until the outermost batch ends (or REImportBatch saves) and are then sent
+// one AssetCreated per asset, so the import loop itself doesn't wait on registry listeners.
+class REAssetBatch {
+public:
+  REAssetBatch() = delete;
+  ~REAssetBatch() = delete;
+
+  // Create an asset at a dump path like "Materials/Foo". A unique name is picked if the path is taken.
+  static UObject* CreateAsset(const FString& Path, UClass* Class, UFactory* Factory);
+
+  static bool IsActive();
+  // Tell the asset registry about the assets created so far
+  static void FlushPending();
+
+private:
+  friend struct FScopedAssetBatch;
+
+  static void Begin();
+  static void End();
+};
+
+// Batches REAssetBatch::CreateAsset calls for its lifetime. Scopes can be nested.
+struct FScopedAssetBatch {
+  FScopedAssetBatch()
+  {
+    REAssetBatch::Begin();
+  }
+
+  ~FScopedAssetBatch()
+  {
+    REAssetBatch::End();
+  }
+
+  FScopedAssetBatch(const FScopedAssetBatch&) = delete;
+  FScopedAssetBatch& operator=(const FScopedAssetBatch&) = delete;
+};
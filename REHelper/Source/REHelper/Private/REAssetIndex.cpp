@@ -0,0 +1,181 @@
+#include "REAssetIndex.h"
+
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "Serialization/NameAsStringProxyArchive.h"
+
+namespace
+{
+  const uint32 IndexMagic = 0x58494552; // "REIX"
+  // Bump when the layout changes
+  const int32 IndexVersion = 1;
+
+  struct FPackageFile {
+    FString Name;
+    int64 Timestamp = 0;
+
+    bool operator==(const FPackageFile& Other) const
+    {
+      return Timestamp == Other.Timestamp && Name == Other.Name;
+    }
+
+    friend FArchive& operator<<(FArchive& Ar, FPackageFile& File)
+    {
+      return Ar << File.Name << File.Timestamp;
+    }
+  };
+
+  struct FIndexedDirectory {
+    // Sorted by name
+    TArray<FPackageFile> Files;
+    TArray<FIndexedAsset> Assets;
+
+    friend FArchive& operator<<(FArchive& Ar, FIndexedDirectory& Dir)
+    {
+      return Ar << Dir.Files << Dir.Assets;
+    }
+  };
+
+  TMap<FString, FIndexedDirectory> Directories;
+  bool bLoaded = false;
+  bool bDirty = false;
+
+  void LoadIndex()
+  {
+    if (bLoaded)
+    {
+      return;
+    }
+    bLoaded = true;
+    TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*REAssetIndex::GetIndexPath(), FILEREAD_Silent));
+    if (!Reader)
+    {
+      return;
+    }
+    FNameAsStringProxyArchive Ar(*Reader);
+    uint32 Magic = 0;
+    int32 Version = 0;
+    Ar << Magic << Version;
+    if (Magic != IndexMagic || Version != IndexVersion)
+    {
+      return;
+    }
+    Ar << Directories;
+    if (Reader->IsError())
+    {
+      Directories.Empty();
+    }
+  }
+
+  // Package files of a directory sorted by name
+  bool StatDirectory(const FString& Dir, TArray<FPackageFile>& OutFiles)
+  {
+    FString DiskDir;
+    if (!FPackageName::TryConvertLongPackageNameToFilename(Dir + TEXT("/"), DiskDir))
+    {
+      return false;
+    }
+    const FString AssetExtension = FPackageName::GetAssetPackageExtension();
+    const FString MapExtension = FPackageName::GetMapPackageExtension();
+    FPlatformFileManager::Get().GetPlatformFile().IterateDirectoryStat(*DiskDir, [&](const TCHAR* Filename, const FFileStatData& Stat) {
+      if (!Stat.bIsDirectory)
+      {
+        const FString Extension = FPaths::GetExtension(Filename, true);
+        if (Extension == AssetExtension || Extension == MapExtension)
+        {
+          OutFiles.Add({ FPaths::GetCleanFilename(Filename), Stat.ModificationTime.GetTicks() });
+        }
+      }
+      return true;
+    });
+    OutFiles.Sort([](const FPackageFile& A, const FPackageFile& B) {
+      return A.Name < B.Name;
+    });
+    return true;
+  }
+}
+
+bool REAssetIndex::Find(const FString& Dir, TArray<FIndexedAsset>& OutAssets)
+{
+  LoadIndex();
+  const FIndexedDirectory* Stored = Directories.Find(Dir);
+  TArray<FPackageFile> Files;
+  if (!Stored || !StatDirectory(Dir, Files) || Files != Stored->Files)
+  {
+    return false;
+  }
+  OutAssets = Stored->Assets;
+  return true;
+}
+
+void REAssetIndex::Update(const FString& Dir, const TArray<FIndexedAsset>& Assets)
+{
+  LoadIndex();
+  FIndexedDirectory Entry;
+  if (!StatDirectory(Dir, Entry.Files))
+  {
+    return;
+  }
+  // Assets that exist only in memory would be gone in the next session
+  TSet<FString> Saved;
+  for (const FPackageFile& File : Entry.Files)
+  {
+    Saved.Add(FPaths::GetBaseFilename(File.Name));
+  }
+  for (const FIndexedAsset& Asset : Assets)
+  {
+    if (!Saved.Contains(FPackageName::GetShortName(FPackageName::ObjectPathToPackageName(Asset.ObjectPath.ToString()))))
+    {
+      Invalidate(Dir);
+      return;
+    }
+  }
+  Entry.Assets = Assets;
+  Directories.Add(Dir, MoveTemp(Entry));
+  bDirty = true;
+}
+
+void REAssetIndex::Invalidate(const FString& Dir)
+{
+  LoadIndex();
+  if (Directories.Remove(Dir))
+  {
+    bDirty = true;
+  }
+}
+
+void REAssetIndex::Flush()
+{
+  if (!bDirty)
+  {
+    return;
+  }
+  bDirty = false;
+  const FString IndexPath = GetIndexPath();
+  const FString TempPath = IndexPath + TEXT(".tmp");
+  TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*TempPath, FILEWRITE_Silent));
+  if (!Writer)
+  {
+    UE_LOG(LogTemp, Warning, TEXT("RE Helper: Failed to create asset index \"%s\""), *IndexPath);
+    return;
+  }
+  FNameAsStringProxyArchive Ar(*Writer);
+  uint32 Magic = IndexMagic;
+  int32 Version = IndexVersion;
+  Ar << Magic << Version;
+  Ar << Directories;
+  const bool bWritten = Writer->Close();
+  Writer.Reset();
+  if (!bWritten || !IFileManager::Get().Move(*IndexPath, *TempPath, true, true, false, true))
+  {
+    IFileManager::Get().Delete(*TempPath, false, true, true);
+    UE_LOG(LogTemp, Warning, TEXT("RE Helper: Failed to write asset index \"%s\""), *IndexPath);
+  }
+}
+
+FString REAssetIndex::GetIndexPath()
+{
+  return FPaths::ProjectSavedDir() / TEXT("REHelper") / TEXT("AssetIndex.bin");
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "CoreMinimal.h"
+
+// Asset of an indexed directory
+struct FIndexedAsset {
+  FName ObjectPath;
+  // Short class name as the asset registry reports it
+  FName Class;
+
+  friend FArchive& operator<<(FArchive& Ar, FIndexedAsset& Asset)
+  {
+    return Ar << Asset.ObjectPath << Asset.Class;
+  }
+};
+
+// Asset lists of /Game/ directories kept in Saved/REHelper between editor sessions.
+// A stored list is valid while the package files of its directory and their timestamps are unchanged.
+class REAssetIndex {
+public:
+  REAssetIndex() = delete;
+  ~REAssetIndex() = delete;
+
+  // Get the assets of a long package path like "/Game/Textures". Returns false if there is no valid list.
+  static bool Find(const FString& Dir, TArray<FIndexedAsset>& OutAssets);
+  // Store the assets of a directory as the asset registry reports them. Ignored if some of them are not saved yet.
+  static void Update(const FString& Dir, const TArray<FIndexedAsset>& Assets);
+  // Forget a directory. Call it when an asset is created there.
+  static void Invalidate(const FString& Dir);
+  // Write changes to disk
+  static void Flush();
+
+  static FString GetIndexPath();
+};
@@ -0,0 +1,908 @@
+#include "REDump.h"
+#include "REDumpStream.h"
+#include "REScanner.h"
+#include "Core/REDumpCore.h"
+
+#include "Async/MappedFileHandle.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Containers/StringView.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/BufferReader.h"
+#include "Serialization/NameAsStringProxyArchive.h"
+
+namespace
+{
+  inline FAnsiStringView ToView(std::string_view View)
+  {
+    return FAnsiStringView(View.data(), (int32)View.size());
+  }
+
+  // The only place where a field gets copied to the heap
+  inline FString ToString(FAnsiStringView View, const TCHAR* Suffix = nullptr)
+  {
+    FUTF8ToTCHAR Converted(View.GetData(), View.Len());
+    const int32 SuffixLen = Suffix ? FCString::Strlen(Suffix) : 0;
+    FString Result;
+    Result.Reserve(Converted.Length() + SuffixLen);
+    Result.AppendChars(Converted.Get(), Converted.Length());
+    if (SuffixLen)
+    {
+      Result.AppendChars(Suffix, SuffixLen);
+    }
+    return Result;
+  }
+
+  inline FString ToString(std::string_view View, const TCHAR* Suffix = nullptr)
+  {
+    return ToString(ToView(View), Suffix);
+  }
+
+  // Parameter names and texture paths repeat across thousands of materials. Intern them.
+  inline FName ToName(std::string_view View, const TCHAR* Suffix = nullptr)
+  {
+    if (Suffix)
+    {
+      return FName(*ToString(View, Suffix));
+    }
+    FUTF8ToTCHAR Converted(View.data(), (int32)View.size());
+    return FName(Converted.Length(), Converted.Get());
+  }
+
+  // Replaces the value of an existing parameter like TMap::Add did
+  template <typename TValue>
+  void SetParameter(TArray<TPair<FName, TValue>>& Parameters, FName Name, const TValue& Value)
+  {
+    for (TPair<FName, TValue>& Parameter : Parameters)
+    {
+      if (Parameter.Key == Name)
+      {
+        Parameter.Value = Value;
+        return;
+      }
+    }
+    Parameters.Emplace(Name, Value);
+  }
+
+  TAutoConsoleVariable<int32> CVarDumpCache(
+    TEXT("REHelper.DumpCache"),
+    1,
+    TEXT("Cache parsed RE dumps in a binary file next to the dump and reuse it while the dump is unchanged."));
+
+  const uint32 CacheMagic = 0x43484552; // "REHC"
+  // Bump when the layout of any cached record changes
+  const int32 CacheVersion = 3;
+
+  enum class EDumpKind : uint8 {
+    Materials,
+    Textures,
+    DefaultMaterials,
+    SpeedTreeOverrides
+  };
+
+  struct FDumpCacheHeader {
+    uint32 Magic = CacheMagic;
+    int32 Version = CacheVersion;
+    uint8 Kind = 0;
+    int64 FileSize = 0;
+    int64 Timestamp = 0;
+    uint64 Hash = 0;
+
+    friend FArchive& operator<<(FArchive& Ar, FDumpCacheHeader& Header)
+    {
+      return Ar << Header.Magic << Header.Version << Header.Kind << Header.FileSize << Header.Timestamp << Header.Hash;
+    }
+  };
+
+  // Parse a piece of a dump that starts at an entry. Returns the number of lines in Text.
+  template <typename TRecord>
+  using TDumpParser = TFunctionRef<int32(std::string_view Text, TArray<TRecord>& OutRecords, TArray<int32>& OutErrorLines)>;
+
+  // Chunks smaller than this are not worth a task
+  const int32 MinParseChunkSize = 256 * 1024;
+
+  template <typename TRecord>
+  struct TParseChunk {
+    const ANSICHAR* Begin = nullptr;
+    const ANSICHAR* End = nullptr;
+    int32 NumLines = 0;
+    TArray<TRecord> Records;
+    // Chunk relative indices of malformed entries
+    TArray<int32> ErrorLines;
+  };
+
+  // Split the text at top level entries and parse the chunks in parallel. Records are merged in the file order.
+  // FirstLine is the line number of Body in the dump. Returns the number of parsed lines.
+  template <typename TRecord>
+  int32 ParseParallel(const FString& Path, FAnsiStringView Body, int32 FirstLine, TArray<TRecord>& OutRecords, bool& OutHadErrors, TDumpParser<TRecord> Parse)
+  {
+    const ANSICHAR* Begin = Body.GetData();
+    const ANSICHAR* End = Begin + Body.Len();
+    const int32 MaxChunks = FMath::Max(1, FTaskGraphInterface::Get().GetNumWorkerThreads() * 4);
+    const int32 NumChunks = FMath::Clamp(Body.Len() / MinParseChunkSize, 1, MaxChunks);
+
+    TArray<TParseChunk<TRecord>> Chunks;
+    Chunks.Reserve(NumChunks);
+    const ANSICHAR* ChunkBegin = Begin;
+    for (int32 Idx = 1; Idx < NumChunks && ChunkBegin < End; ++Idx)
+    {
+      const ANSICHAR* Target = Begin + (int64)Body.Len() * Idx / NumChunks;
+      const ANSICHAR* ChunkEnd = REScanner::FindEntryStart(FMath::Max(Target, ChunkBegin), End);
+      if (ChunkEnd == End)
+      {
+        break;
+      }
+      TParseChunk<TRecord>& Chunk = Chunks.AddDefaulted_GetRef();
+      Chunk.Begin = ChunkBegin;
+      Chunk.End = ChunkEnd;
+      ChunkBegin = ChunkEnd;
+    }
+    TParseChunk<TRecord>& LastChunk = Chunks.AddDefaulted_GetRef();
+    LastChunk.Begin = ChunkBegin;
+    LastChunk.End = End;
+
+    ParallelFor(Chunks.Num(), [&](int32 Idx) {
+      TParseChunk<TRecord>& Chunk = Chunks[Idx];
+      Chunk.NumLines = Parse(std::string_view(Chunk.Begin, Chunk.End - Chunk.Begin), Chunk.Records, Chunk.ErrorLines);
+    });
+
+    int32 NumRecords = 0;
+    for (const TParseChunk<TRecord>& Chunk : Chunks)
+    {
+      NumRecords += Chunk.Records.Num();
+    }
+    OutRecords.Reserve(OutRecords.Num() + NumRecords);
+
+    int32 LineOffset = FirstLine;
+    for (TParseChunk<TRecord>& Chunk : Chunks)
+    {
+      for (int32 ErrorLine : Chunk.ErrorLines)
+      {
+        UE_LOG(LogTemp, Error, TEXT("RE Helper: Failed to parse entry at line %d of \"%s\""), LineOffset + ErrorLine + 1, *Path);
+        OutHadErrors = true;
+      }
+      LineOffset += Chunk.NumLines;
+      OutRecords.Append(MoveTemp(Chunk.Records));
+    }
+    return LineOffset - FirstLine;
+  }
+
+  // Initial size of the decompression window. Grows if a single entry doesn't fit.
+  const int32 StreamWindowSize = 8 * 1024 * 1024;
+
+  // Parse a compressed dump while it is being inflated. Only the window and the records are kept in memory.
+  template <typename TRecord>
+  int32 ParseStream(const FString& Path, FDumpStream& Stream, TArray<TRecord>& OutRecords, bool& OutHadErrors, TDumpParser<TRecord> Parse)
+  {
+    TArray<uint8> Window;
+    Window.SetNumUninitialized(StreamWindowSize);
+    int32 Filled = 0;
+    int32 NumLines = 0;
+    bool bBomChecked = false;
+    for (;;)
+    {
+      const int64 Count = Stream.Read(Window.GetData() + Filled, Window.Num() - Filled);
+      if (Count < 0)
+      {
+        UE_LOG(LogTemp, Error, TEXT("RE Helper: %s (\"%s\")"), *Stream.GetError(), *Path);
+        OutHadErrors = true;
+        return NumLines;
+      }
+      Filled += (int32)Count;
+      const bool bEnd = Count == 0;
+      if (!bEnd && Filled < Window.Num())
+      {
+        continue;
+      }
+
+      if (!bBomChecked && (Filled >= 3 || bEnd))
+      {
+        bBomChecked = true;
+        if (Filled >= 3 && Window[0] == 0xEF && Window[1] == 0xBB && Window[2] == 0xBF)
+        {
+          Filled -= 3;
+          FMemory::Memmove(Window.GetData(), Window.GetData() + 3, Filled);
+        }
+        else if (Filled >= 2 && ((Window[0] == 0xFF && Window[1] == 0xFE) || (Window[0] == 0xFE && Window[1] == 0xFF)))
+        {
+          UE_LOG(LogTemp, Error, TEXT("RE Helper: Compressed UTF-16 dumps are not supported (\"%s\")"), *Path);
+          OutHadErrors = true;
+          return NumLines;
+        }
+      }
+
+      const ANSICHAR* Begin = (const ANSICHAR*)Window.GetData();
+      const ANSICHAR* BlockEnd = bEnd ? Begin + Filled : REScanner::FindLastEntryStart(Begin, Begin + Filled);
+      if (BlockEnd == Begin && !bEnd)
+      {
+        // A single entry is larger than the window
+        Window.SetNumUninitialized(Window.Num() * 2);
+        continue;
+      }
+      NumLines += ParseParallel(Path, FAnsiStringView(Begin, (int32)(BlockEnd - Begin)), NumLines, OutRecords, OutHadErrors, Parse);
+      Filled -= (int32)(BlockEnd - Begin);
+      FMemory::Memmove(Window.GetData(), BlockEnd, Filled);
+      if (bEnd)
+      {
+        return NumLines;
+      }
+    }
+  }
+
+  template <typename TRecord>
+  void WriteCache(const FString& CachePath, FDumpCacheHeader& Header, TArray<TRecord>& Records)
+  {
+    const FString TempPath = CachePath + TEXT(".tmp");
+    TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*TempPath, FILEWRITE_Silent));
+    if (!Writer)
+    {
+      UE_LOG(LogTemp, Warning, TEXT("RE Helper: Failed to create dump cache \"%s\""), *CachePath);
+      return;
+    }
+    // Names are stored as strings
+    FNameAsStringProxyArchive Ar(*Writer);
+    Ar << Header;
+    Ar << Records;
+    const bool bWritten = Writer->Close();
+    Writer.Reset();
+    if (!bWritten || !IFileManager::Get().Move(*CachePath, *TempPath, true, true, false, true))
+    {
+      IFileManager::Get().Delete(*TempPath, false, true, true);
+      UE_LOG(LogTemp, Warning, TEXT("RE Helper: Failed to write dump cache \"%s\""), *CachePath);
+    }
+  }
+
+  // Read the cache if it matches the dump. May map the dump to OutDump to verify its hash.
+  template <typename TRecord>
+  bool ReadCache(const FString& Path, const FDumpCacheHeader& Expected, FDumpText& OutDump, TArray<TRecord>& OutRecords)
+  {
+    const FString CachePath = REDump::GetCachePath(Path);
+    // Mapped region must be released before the file handle
+    TUniquePtr<IMappedFileHandle> MappedFile(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*CachePath));
+    TUniquePtr<IMappedFileRegion> MappedRegion(MappedFile ? MappedFile->MapRegion() : nullptr);
+    TArray<uint8> CacheBytes;
+    uint8* CacheData = nullptr;
+    int64 CacheSize = 0;
+    if (MappedRegion)
+    {
+      CacheData = const_cast<uint8*>(MappedRegion->GetMappedPtr());
+      CacheSize = MappedRegion->GetMappedSize();
+    }
+    else if (FFileHelper::LoadFileToArray(CacheBytes, *CachePath, FILEREAD_Silent))
+    {
+      CacheData = CacheBytes.GetData();
+      CacheSize = CacheBytes.Num();
+    }
+    if (!CacheData)
+    {
+      return false;
+    }
+
+    FBufferReader Reader(CacheData, CacheSize, false, true);
+    FNameAsStringProxyArchive Ar(Reader);
+    FDumpCacheHeader Header;
+    Ar << Header;
+    if (Reader.IsError() || Header.Magic != Expected.Magic || Header.Version != Expected.Version || Header.Kind != Expected.Kind || Header.FileSize != Expected.FileSize)
+    {
+      return false;
+    }
+
+    if (Header.Timestamp != Expected.Timestamp)
+    {
+      // The dump was touched or copied. Accept the cache only if the content is the same.
+      if (!OutDump.Num() && !OutDump.Map(Path))
+      {
+        return false;
+      }
+      if (FDumpStream::HashBytes(OutDump.GetData(), OutDump.Num()) != Header.Hash)
+      {
+        return false;
+      }
+    }
+
+    Ar << OutRecords;
+    if (Reader.IsError())
+    {
+      OutRecords.Empty();
+      return false;
+    }
+    return true;
+  }
+
+  template <typename TRecord>
+  bool LoadDump(const FString& Path, EDumpKind Kind, TArray<TRecord>& OutRecords, bool& OutHadErrors, TDumpParser<TRecord> Parse)
+  {
+    OutHadErrors = false;
+    const double StartTime = FPlatformTime::Seconds();
+    FDumpCacheHeader Header;
+    Header.Kind = (uint8)Kind;
+    Header.FileSize = IFileManager::Get().FileSize(*Path);
+    Header.Timestamp = IFileManager::Get().GetTimeStamp(*Path).GetTicks();
+    if (Header.FileSize <= 0)
+    {
+      return false;
+    }
+
+    const bool bUseCache = CVarDumpCache.GetValueOnAnyThread() != 0;
+    FDumpText Dump;
+    if (bUseCache && ReadCache(Path, Header, Dump, OutRecords))
+    {
+      UE_LOG(LogTemp, Display, TEXT("RE Helper: Loaded %d entries of \"%s\" from cache in %.2f ms"), OutRecords.Num(), *Path, (FPlatformTime::Seconds() - StartTime) * 1000.);
+      return true;
+    }
+
+    FDumpStream Stream;
+    FString StreamError;
+    if (!Stream.Open(Path, StreamError))
+    {
+      UE_LOG(LogTemp, Error, TEXT("RE Helper: %s"), *StreamError);
+      return false;
+    }
+
+    int32 NumLines = 0;
+    if (Stream.IsCompressed())
+    {
+      NumLines = ParseStream(Path, Stream, OutRecords, OutHadErrors, Parse);
+      Header.Hash = Stream.GetRawHash();
+    }
+    else
+    {
+      if (!Dump.Num() && !Dump.Map(Path))
+      {
+        return false;
+      }
+      if (bUseCache)
+      {
+        Header.Hash = FDumpStream::HashBytes(Dump.GetData(), Dump.Num());
+      }
+      NumLines = ParseParallel(Path, Dump.Decode(), 0, OutRecords, OutHadErrors, Parse);
+    }
+    if (!NumLines)
+    {
+      return false;
+    }
+    UE_LOG(LogTemp, Display, TEXT("RE Helper: Parsed %d entries (%d lines) of \"%s\" in %.2f ms"), OutRecords.Num(), NumLines, *Path, (FPlatformTime::Seconds() - StartTime) * 1000.);
+
+    // Don't cache malformed dumps. Errors must be reported on every run.
+    if (bUseCache && !OutHadErrors && OutRecords.Num())
+    {
+      WriteCache(REDump::GetCachePath(Path), Header, OutRecords);
+    }
+    return true;
+  }
+
+  void ConvertEntry(const REDumpCore::MaterialEntry& Entry, RMaterial& Material)
+  {
+    Material.Name = ToString(Entry.Name);
+    Material.Class = ToName(Entry.Class);
+    Material.ParentName = ToString(Entry.ParentName);
+    Material.TwoSided = Entry.TwoSided;
+    for (const REDumpCore::MaterialParameter& Parameter : Entry.Parameters)
+    {
+      switch (Parameter.Type)
+      {
+      case REDumpCore::EParameterType::Bool:
+        SetParameter(Material.BoolParameters, ToName(Parameter.Name), Parameter.Bool);
+        break;
+      case REDumpCore::EParameterType::Scalar:
+        SetParameter(Material.ScalarParameters, ToName(Parameter.Name), Parameter.Value[0]);
+        break;
+      case REDumpCore::EParameterType::Texture:
+        SetParameter(Material.TextureParameters, ToName(Parameter.Name), ToName(Parameter.Texture));
+        break;
+      case REDumpCore::EParameterType::TextureA:
+        SetParameter(Material.TextureParameters, ToName(Parameter.Name), ToName(Parameter.Texture));
+        SetParameter(Material.TextureAParameters, ToName(Parameter.Name, TEXT("_Alpha")), ToName(Parameter.Texture, TEXT("_Alpha")));
+        break;
+      case REDumpCore::EParameterType::Vector:
+        SetParameter(Material.VectorParameters, ToName(Parameter.Name), FLinearColor(Parameter.Value[0], Parameter.Value[1], Parameter.Value[2], Parameter.Value[3]));
+        break;
+      }
+    }
+    Material.BoolParameters.Shrink();
+    Material.ScalarParameters.Shrink();
+    Material.TextureParameters.Shrink();
+    Material.TextureAParameters.Shrink();
+    Material.VectorParameters.Shrink();
+  }
+
+  void ConvertEntry(const REDumpCore::TextureEntry& Entry, RTexture& Texture)
+  {
+    Texture.Name = ToString(Entry.Name);
+    Texture.Compression = ToString(Entry.Compression);
+    Texture.Source = ToString(Entry.Source);
+    Texture.SRGB = Entry.SRGB;
+    Texture.IsDXT = Entry.IsDXT;
+  }
+
+  void ConvertEntry(const REDumpCore::DefaultMaterialsEntry& Entry, RDefaultMaterials& Record)
+  {
+    Record.Name = ToString(Entry.Name);
+    Record.Materials.Reserve((int32)Entry.Materials.size());
+    for (std::string_view Material : Entry.Materials)
+    {
+      Record.Materials.Add(ToString(Material));
+    }
+  }
+
+  void ConvertEntry(const REDumpCore::SpeedTreeOverrideEntry& Entry, RSpeedTreeOverride& Record)
+  {
+    Record.ActorName = ToString(Entry.ActorName);
+    Record.Overrides.Reserve((int32)Entry.Overrides.size());
+    for (const REDumpCore::MaterialOverride& Override : Entry.Overrides)
+    {
+      RMaterialOverride& Item = Record.Overrides.AddDefaulted_GetRef();
+      Item.Slot = ToString(Override.Slot);
+      Item.Material = ToString(Override.Material);
+    }
+  }
+
+  // Run a REDumpCore parser and convert its entries to records
+  template <typename TEntry, typename TRecord>
+  int32 ParseWithCore(std::string_view Text, TArray<TRecord>& OutRecords, TArray<int32>& OutErrorLines, size_t (*CoreParse)(std::string_view, std::vector<TEntry>&, std::vector<size_t>&))
+  {
+    std::vector<TEntry> Entries;
+    std::vector<size_t> ErrorLines;
+    const size_t NumLines = CoreParse(Text, Entries, ErrorLines);
+    OutRecords.Reserve(OutRecords.Num() + (int32)Entries.size());
+    for (const TEntry& Entry : Entries)
+    {
+      ConvertEntry(Entry, OutRecords.AddDefaulted_GetRef());
+    }
+    for (size_t ErrorLine : ErrorLines)
+    {
+      OutErrorLines.Add((int32)ErrorLine);
+    }
+    return (int32)NumLines;
+  }
+
+  // REHelper.BenchmarkScanner <Path>. Compares the old FString based line reading with the byte scanner.
+  void BenchmarkScanner(const TArray<FString>& Args)
+  {
+    if (!Args.Num())
+    {
+      UE_LOG(LogTemp, Warning, TEXT("RE Helper: Usage: REHelper.BenchmarkScanner <Path to a dump file>"));
+      return;
+    }
+    const FString& Path = Args[0];
+    const int64 Size = IFileManager::Get().FileSize(*Path);
+    if (Size <= 0)
+    {
+      UE_LOG(LogTemp, Error, TEXT("RE Helper: Can't read \"%s\""), *Path);
+      return;
+    }
+
+    auto Report = [&](const TCHAR* Name, double StartTime, int32 NumLines, int32 NumFields) {
+      const double Seconds = FMath::Max(FPlatformTime::Seconds() - StartTime, 1e-6);
+      UE_LOG(LogTemp, Display, TEXT("RE Helper: %-24s %9.2f ms %9.1f MB/s (%d lines, %d separators)"), Name, Seconds * 1000., Size / Seconds / (1024. * 1024.), NumLines, NumFields);
+    };
+
+    {
+      const double StartTime = FPlatformTime::Seconds();
+      TArray<FString> Lines;
+      FFileHelper::LoadFileToStringArray(Lines, *Path);
+      int32 NumFields = 0;
+      for (const FString& Line : Lines)
+      {
+        for (int32 Pos = Line.Find(TEXT("\t")); Pos != INDEX_NONE; Pos = Line.Find(TEXT("\t"), ESearchCase::IgnoreCase, ESearchDir::FromStart, Pos + 1))
+        {
+          NumFields++;
+        }
+      }
+      Report(TEXT("FString + Find"), StartTime, Lines.Num(), NumFields);
+    }
+
+    for (const bool bScalar : { true, false })
+    {
+      REScanner::SetForceScalar(bScalar);
+      const double StartTime = FPlatformTime::Seconds();
+      FDumpText Text;
+      REDump::LoadText(Path, Text);
+      int32 NumFields = 0;
+      for (const FAnsiStringView& Line : Text.Lines)
+      {
+        const ANSICHAR* End = Line.GetData() + Line.Len();
+        for (const ANSICHAR* Ptr = REScanner::FindChar(Line.GetData(), End, REDumpCore::VSEP_CHAR); Ptr != End; Ptr = REScanner::FindChar(Ptr + 1, End, REDumpCore::VSEP_CHAR))
+        {
+          NumFields++;
+        }
+      }
+      Report(REScanner::GetInstructionSet(), StartTime, Text.Lines.Num(), NumFields);
+    }
+    REScanner::SetForceScalar(false);
+  }
+
+  FAutoConsoleCommand BenchmarkScannerCommand(
+    TEXT("REHelper.BenchmarkScanner"),
+    TEXT("Measure dump scanning throughput. Usage: REHelper.BenchmarkScanner <Path to a dump file>"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkScanner));
+
+  // The layout RMaterial had before the parameters were flattened. Used by the memory report only.
+  struct FLegacyMaterial {
+    FString Name;
+    FString Class;
+    FString ParentName;
+    TMap<FString, bool> BoolParameters;
+    TMap<FString, float> ScalarParameters;
+    TMap<FString, FString> TextureParameters;
+    TMap<FString, FString> TextureAParameters;
+    TMap<FString, FLinearColor> VectorParameters;
+
+    explicit FLegacyMaterial(const RMaterial& Material)
+      : Name(Material.Name)
+      , Class(Material.Class.ToString())
+      , ParentName(Material.ParentName)
+    {
+      for (const TPair<FName, bool>& P : Material.BoolParameters)
+      {
+        BoolParameters.Add(P.Key.ToString(), P.Value);
+      }
+      for (const TPair<FName, float>& P : Material.ScalarParameters)
+      {
+        ScalarParameters.Add(P.Key.ToString(), P.Value);
+      }
+      for (const TPair<FName, FName>& P : Material.TextureParameters)
+      {
+        TextureParameters.Add(P.Key.ToString(), P.Value.ToString());
+      }
+      for (const TPair<FName, FName>& P : Material.TextureAParameters)
+      {
+        TextureAParameters.Add(P.Key.ToString(), P.Value.ToString());
+      }
+      for (const TPair<FName, FLinearColor>& P : Material.VectorParameters)
+      {
+        VectorParameters.Add(P.Key.ToString(), P.Value);
+      }
+    }
+
+    template <typename TValue>
+    static SIZE_T GetMapSize(const TMap<FString, TValue>& Map)
+    {
+      SIZE_T Size = Map.GetAllocatedSize();
+      for (const TPair<FString, TValue>& Pair : Map)
+      {
+        Size += Pair.Key.GetAllocatedSize();
+      }
+      return Size;
+    }
+
+    static SIZE_T GetMapSize(const TMap<FString, FString>& Map)
+    {
+      SIZE_T Size = Map.GetAllocatedSize();
+      for (const TPair<FString, FString>& Pair : Map)
+      {
+        Size += Pair.Key.GetAllocatedSize() + Pair.Value.GetAllocatedSize();
+      }
+      return Size;
+    }
+
+    SIZE_T GetAllocatedSize() const
+    {
+      return sizeof(FLegacyMaterial) + Name.GetAllocatedSize() + Class.GetAllocatedSize() + ParentName.GetAllocatedSize() +
+        GetMapSize(BoolParameters) + GetMapSize(ScalarParameters) + GetMapSize(TextureParameters) + GetMapSize(TextureAParameters) + GetMapSize(VectorParameters);
+    }
+  };
+
+  // REHelper.MaterialMemory <Path>. Compares the memory of parsed materials with the old TMap<FString> layout.
+  void ReportMaterialMemory(const TArray<FString>& Args)
+  {
+    if (!Args.Num())
+    {
+      UE_LOG(LogTemp, Warning, TEXT("RE Helper: Usage: REHelper.MaterialMemory <Path to MaterialsList.txt>"));
+      return;
+    }
+    TArray<RMaterial> Materials;
+    bool bErrors = false;
+    if (!REDump::LoadMaterials(Args[0], Materials, bErrors) || !Materials.Num())
+    {
+      UE_LOG(LogTemp, Error, TEXT("RE Helper: Can't read \"%s\""), *Args[0]);
+      return;
+    }
+
+    SIZE_T FlatSize = Materials.GetAllocatedSize() - Materials.Num() * sizeof(RMaterial);
+    TSet<FName> Names;
+    auto AddNames = [&](const auto& Parameters) {
+      for (const auto& P : Parameters)
+      {
+        Names.Add(P.Key);
+      }
+    };
+    SIZE_T LegacySize = 0;
+    for (const RMaterial& Material : Materials)
+    {
+      FlatSize += Material.GetAllocatedSize();
+      LegacySize += FLegacyMaterial(Material).GetAllocatedSize();
+      Names.Add(Material.Class);
+      AddNames(Material.BoolParameters);
+      AddNames(Material.ScalarParameters);
+      AddNames(Material.VectorParameters);
+      for (const TPair<FName, FName>& P : Material.TextureParameters)
+      {
+        Names.Add(P.Key);
+        Names.Add(P.Value);
+      }
+      for (const TPair<FName, FName>& P : Material.TextureAParameters)
+      {
+        Names.Add(P.Key);
+        Names.Add(P.Value);
+      }
+    }
+    // Interned strings are shared by all materials. Count each of them once.
+    SIZE_T NameSize = 0;
+    for (const FName& Name : Names)
+    {
+      NameSize += sizeof(FNameEntryId) + (Name.GetPlainNameString().Len() + 1) * sizeof(TCHAR);
+    }
+
+    const int32 Num = Materials.Num();
+    UE_LOG(LogTemp, Display, TEXT("RE Helper: %d materials, %d unique names"), Num, Names.Num());
+    UE_LOG(LogTemp, Display, TEXT("RE Helper: TMap<FString> layout: %8.2f MB, %6llu bytes per material"), LegacySize / (1024. * 1024.), (uint64)(LegacySize / Num));
+    UE_LOG(LogTemp, Display, TEXT("RE Helper: Flat FName layout:    %8.2f MB, %6llu bytes per material (%.2f MB of interned names)"), (FlatSize + NameSize) / (1024. * 1024.), (uint64)((FlatSize + NameSize) / Num), NameSize / (1024. * 1024.));
+  }
+
+  FAutoConsoleCommand MaterialMemoryCommand(
+    TEXT("REHelper.MaterialMemory"),
+    TEXT("Report memory used by parsed materials. Usage: REHelper.MaterialMemory <Path to MaterialsList.txt>"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&ReportMaterialMemory));
+}
+
+SIZE_T RMaterial::GetAllocatedSize() const
+{
+  return sizeof(RMaterial) + Name.GetAllocatedSize() + ParentName.GetAllocatedSize() + BoolParameters.GetAllocatedSize() + ScalarParameters.GetAllocatedSize() +
+    TextureParameters.GetAllocatedSize() + TextureAParameters.GetAllocatedSize() + VectorParameters.GetAllocatedSize();
+}
+
+FArchive& operator<<(FArchive& Ar, RMaterial& Material)
+{
+  Ar << Material.Name << Material.Class << Material.ParentName;
+  Ar << Material.BoolParameters << Material.ScalarParameters << Material.TextureParameters << Material.TextureAParameters << Material.VectorParameters;
+  Ar << Material.TwoSided;
+  return Ar;
+}
+
+FArchive& operator<<(FArchive& Ar, RTexture& Texture)
+{
+  return Ar << Texture.Name << Texture.Compression << Texture.Source << Texture.SRGB << Texture.IsDXT;
+}
+
+FArchive& operator<<(FArchive& Ar, RDefaultMaterials& Entry)
+{
+  return Ar << Entry.Name << Entry.Materials;
+}
+
+FArchive& operator<<(FArchive& Ar, RMaterialOverride& Override)
+{
+  return Ar << Override.Slot << Override.Material;
+}
+
+FArchive& operator<<(FArchive& Ar, RSpeedTreeOverride& Entry)
+{
+  return Ar << Entry.ActorName << Entry.Overrides;
+}
+
+bool REDump::LoadMaterials(const FString& Path, TArray<RMaterial>& OutMaterials, bool& OutHadErrors)
+{
+  return LoadDump<RMaterial>(Path, EDumpKind::Materials, OutMaterials, OutHadErrors, [](std::string_view Text, TArray<RMaterial>& Materials, TArray<int32>& ErrorLines) {
+    return ParseWithCore(Text, Materials, ErrorLines, &REDumpCore::ParseMaterials);
+  });
+}
+
+int32 REDump::ParseMaterials(FAnsiStringView Text, TArray<RMaterial>& OutMaterials, TArray<int32>& OutErrorLines)
+{
+  return ParseWithCore(std::string_view(Text.GetData(), Text.Len()), OutMaterials, OutErrorLines, &REDumpCore::ParseMaterials);
+}
+
+bool REDump::LoadTextures(const FString& Path, TArray<RTexture>& OutTextures, bool& OutHadErrors)
+{
+  return LoadDump<RTexture>(Path, EDumpKind::Textures, OutTextures, OutHadErrors, [](std::string_view Text, TArray<RTexture>& Textures, TArray<int32>& ErrorLines) {
+    return ParseWithCore(Text, Textures, ErrorLines, &REDumpCore::ParseTextures);
+  });
+}
+
+bool REDump::LoadDefaultMaterials(const FString& Path, TArray<RDefaultMaterials>& OutEntries, bool& OutHadErrors)
+{
+  return LoadDump<RDefaultMaterials>(Path, EDumpKind::DefaultMaterials, OutEntries, OutHadErrors, [](std::string_view Text, TArray<RDefaultMaterials>& Entries, TArray<int32>& ErrorLines) {
+    return ParseWithCore(Text, Entries, ErrorLines, &REDumpCore::ParseDefaultMaterials);
+  });
+}
+
+bool REDump::LoadSpeedTreeOverrides(const FString& Path, TArray<RSpeedTreeOverride>& OutEntries, bool& OutHadErrors)
+{
+  return LoadDump<RSpeedTreeOverride>(Path, EDumpKind::SpeedTreeOverrides, OutEntries, OutHadErrors, [](std::string_view Text, TArray<RSpeedTreeOverride>& Entries, TArray<int32>& ErrorLines) {
+    return ParseWithCore(Text, Entries, ErrorLines, &REDumpCore::ParseSpeedTreeOverrides);
+  });
+}
+
+FDumpText::~FDumpText()
+{
+  Unmap();
+}
+
+FDumpText::FDumpText(FDumpText&& Other)
+  : Data(MoveTemp(Other.Data))
+  , Lines(MoveTemp(Other.Lines))
+  , MappedFile(Other.MappedFile)
+  , MappedRegion(Other.MappedRegion)
+{
+  Other.MappedFile = nullptr;
+  Other.MappedRegion = nullptr;
+}
+
+FDumpText& FDumpText::operator=(FDumpText&& Other)
+{
+  if (this != &Other)
+  {
+    Unmap();
+    Data = MoveTemp(Other.Data);
+    Lines = MoveTemp(Other.Lines);
+    Swap(MappedFile, Other.MappedFile);
+    Swap(MappedRegion, Other.MappedRegion);
+  }
+  return *this;
+}
+
+bool FDumpText::Map(const FString& Path)
+{
+  Unmap();
+  Data.Reset();
+  Lines.Reset();
+  const int64 Size = IFileManager::Get().FileSize(*Path);
+  if (Size > MAX_int32)
+  {
+    // Lines are int32 views
+    UE_LOG(LogTemp, Error, TEXT("RE Helper: \"%s\" is too large. Dumps up to 2 GB are supported."), *Path);
+    return false;
+  }
+  if (Size <= 0)
+  {
+    return false;
+  }
+
+  MappedFile = FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Path);
+  MappedRegion = MappedFile ? MappedFile->MapRegion(0, Size) : nullptr;
+  if (!MappedRegion)
+  {
+    // Not every platform file can map. Fall back to a copy.
+    Unmap();
+    return FFileHelper::LoadFileToArray(Data, *Path);
+  }
+  return true;
+}
+
+const uint8* FDumpText::GetData() const
+{
+  return MappedRegion ? MappedRegion->GetMappedPtr() : Data.GetData();
+}
+
+int64 FDumpText::Num() const
+{
+  return MappedRegion ? MappedRegion->GetMappedSize() : Data.Num();
+}
+
+void FDumpText::Unmap()
+{
+  delete MappedRegion;
+  MappedRegion = nullptr;
+  delete MappedFile;
+  MappedFile = nullptr;
+}
+
+FAnsiStringView FDumpText::Decode()
+{
+  const uint8* Bytes = GetData();
+  const int32 Size = (int32)Num();
+  if (Size >= 2 && ((Bytes[0] == 0xFF && Bytes[1] == 0xFE) || (Bytes[0] == 0xFE && Bytes[1] == 0xFF)))
+  {
+    // UTF-16 dump. Convert it to UTF-8 so the byte scanner can handle it.
+    FString Wide;
+    FFileHelper::BufferToString(Wide, Bytes, Size);
+    FTCHARToUTF8 Converted(*Wide);
+    Unmap();
+    Data = TArray<uint8>((const uint8*)Converted.Get(), Converted.Length());
+    return Decode();
+  }
+  int32 Start = 0;
+  if (Size >= 3 && Bytes[0] == 0xEF && Bytes[1] == 0xBB && Bytes[2] == 0xBF)
+  {
+    Start = 3;
+  }
+  return FAnsiStringView((const ANSICHAR*)Bytes + Start, Size - Start);
+}
+
+void FDumpText::Split(bool bCullEmpty)
+{
+  Lines.Reset();
+  const FAnsiStringView Body = Decode();
+  REScanner::SplitLines(Body.GetData(), Body.GetData() + Body.Len(), Lines, bCullEmpty);
+}
+
+namespace
+{
+  void ParseCueText(FDumpCue& Entry)
+  {
+    const FAnsiStringView Body = Entry.Text.Num() ? Entry.Text.Decode() : FAnsiStringView();
+    Entry.bEmpty = !Body.Len();
+    if (!Entry.bEmpty)
+    {
+      Entry.bParsed = REDumpCore::ParseCue(std::string_view(Body.GetData(), Body.Len()), Entry.Cue, Entry.ParseError);
+    }
+  }
+}
+
+void REDump::ParseCues(const TArray<FString>& Files, TArray<FDumpCue>& OutCues)
+{
+  OutCues.Reset();
+  OutCues.SetNum(Files.Num());
+  ParallelFor(Files.Num(), [&](int32 Idx) {
+    FDumpCue& Entry = OutCues[Idx];
+    Entry.File = Files[Idx];
+    if (MapText(Entry.File, Entry.Text))
+    {
+      ParseCueText(Entry);
+    }
+  });
+}
+
+void REDump::ParseCue(const FString& Name, TArray<uint8>&& Data, FDumpCue& OutCue)
+{
+  OutCue.File = Name;
+  OutCue.Text.Data = MoveTemp(Data);
+  ParseCueText(OutCue);
+}
+
+bool REDump::MapText(const FString& Path, FDumpText& OutText)
+{
+  FDumpStream Stream;
+  FString Error;
+  if (!Stream.Open(Path, Error))
+  {
+    UE_LOG(LogTemp, Error, TEXT("RE Helper: %s"), *Error);
+    return false;
+  }
+  if (!Stream.IsCompressed())
+  {
+    return OutText.Map(Path);
+  }
+
+  OutText = FDumpText();
+  TArray<uint8>& Bytes = OutText.Data;
+  for (;;)
+  {
+    const int32 Offset = Bytes.Num();
+    Bytes.AddUninitialized((int32)FDumpStream::BlockSize);
+    const int64 Count = Stream.Read(Bytes.GetData() + Offset, FDumpStream::BlockSize);
+    Bytes.SetNum(Offset + (int32)FMath::Max<int64>(Count, 0), false);
+    if (Count < 0)
+    {
+      UE_LOG(LogTemp, Error, TEXT("RE Helper: %s (\"%s\")"), *Stream.GetError(), *Path);
+      return false;
+    }
+    if (!Count)
+    {
+      return Bytes.Num() > 0;
+    }
+  }
+}
+
+bool REDump::LoadText(const FString& Path, FDumpText& OutText, bool bCullEmpty)
+{
+  if (!MapText(Path, OutText))
+  {
+    return false;
+  }
+  OutText.Split(bCullEmpty);
+  return OutText.Lines.Num() > 0;
+}
+
+FString REDump::ToFString(FAnsiStringView Line)
+{
+  return ToString(Line);
+}
+
+FString REDump::GetCachePath(const FString& Path)
+{
+  return Path + TEXT(".recache");
+}
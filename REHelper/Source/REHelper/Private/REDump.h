@@ -0,0 +1,156 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Containers/StringView.h"
+#include "Core/REDumpCore.h"
+
+// MaterialsList.txt entry. Parameter names, textures and classes are interned as FNames
+// and parameters are kept in flat arrays in the dump order.
+struct RMaterial {
+  FString Name;
+  FName Class;
+  FString ParentName;
+
+  TArray<TPair<FName, bool>> BoolParameters;
+  TArray<TPair<FName, float>> ScalarParameters;
+  // Texture object paths. NAME_None for empty slots.
+  TArray<TPair<FName, FName>> TextureParameters;
+  TArray<TPair<FName, FName>> TextureAParameters;
+  TArray<TPair<FName, FLinearColor>> VectorParameters;
+
+  bool TwoSided = false;
+
+  RMaterial* Parent = nullptr;
+  UObject* UnrealMaterial = nullptr;
+
+  // sizeof(RMaterial) and the heap memory owned by the record. Interned names are not included.
+  SIZE_T GetAllocatedSize() const;
+
+  friend FArchive& operator<<(FArchive& Ar, RMaterial& Material);
+};
+
+// Textures.txt entry
+struct RTexture {
+  FString Name;
+  FString Compression;
+  FString Source;
+  bool SRGB = false;
+  bool IsDXT = false;
+
+  friend FArchive& operator<<(FArchive& Ar, RTexture& Texture);
+};
+
+// DefaultMaterials.txt entry. A mesh and its material slots.
+struct RDefaultMaterials {
+  FString Name;
+  // Material per slot. "None" for empty slots.
+  TArray<FString> Materials;
+
+  friend FArchive& operator<<(FArchive& Ar, RDefaultMaterials& Entry);
+};
+
+// SpeedTreeOverrides.txt material override
+struct RMaterialOverride {
+  // Suffix of the slot name
+  FString Slot;
+  // "None" to clear the slot
+  FString Material;
+
+  friend FArchive& operator<<(FArchive& Ar, RMaterialOverride& Override);
+};
+
+// SpeedTreeOverrides.txt entry. An actor and its material overrides.
+struct RSpeedTreeOverride {
+  FString ActorName;
+  TArray<RMaterialOverride> Overrides;
+
+  friend FArchive& operator<<(FArchive& Ar, RSpeedTreeOverride& Entry);
+};
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+// Dump file split into lines. Lines are UTF-8 views into the dump bytes.
+// Uncompressed dumps are mapped read-only, so the text costs page cache instead of heap.
+struct FDumpText {
+  // Owned bytes of compressed and UTF-16 dumps, or of files that can't be mapped
+  TArray<uint8> Data;
+  TArray<FAnsiStringView> Lines;
+
+  FDumpText() = default;
+  ~FDumpText();
+  FDumpText(FDumpText&& Other);
+  FDumpText& operator=(FDumpText&& Other);
+  FDumpText(const FDumpText&) = delete;
+  FDumpText& operator=(const FDumpText&) = delete;
+
+  // Map an uncompressed file. Reads it to Data if the platform can't map it.
+  bool Map(const FString& Path);
+
+  // Dump bytes, mapped or owned
+  const uint8* GetData() const;
+  int64 Num() const;
+
+  bool IsMapped() const
+  {
+    return MappedRegion != nullptr;
+  }
+
+  // Convert UTF-16 bytes to UTF-8 and get the text without BOM
+  FAnsiStringView Decode();
+  // Split the text to Lines
+  void Split(bool bCullEmpty = true);
+
+private:
+  void Unmap();
+
+  // The region must be released before the handle
+  IMappedFileHandle* MappedFile = nullptr;
+  IMappedFileRegion* MappedRegion = nullptr;
+};
+
+// A .cue file parsed by REDumpCore. Cue points into Text.
+struct FDumpCue {
+  FString File;
+  FDumpText Text;
+  REDumpCore::CueEntry Cue;
+  // The file is missing or empty
+  bool bEmpty = true;
+  bool bParsed = false;
+  // Why REDumpCore rejected the cue. Null if it has no in-game path.
+  const char* ParseError = nullptr;
+};
+
+// Loads RE dump files. Entries are parsed by REDumpCore and converted to the records above.
+// Parsed dumps are cached in a binary file next to the dump and reused until the dump's size,
+// timestamp and content hash change.
+// Gzip compressed dumps are parsed while they are being inflated. Uncompressed ones are parsed from a read-only mapping.
+class REDump {
+public:
+  REDump() = delete;
+  ~REDump() = delete;
+
+  // Each loader returns false if the file is missing or empty. OutHadErrors is set if some entries were malformed.
+  static bool LoadMaterials(const FString& Path, TArray<RMaterial>& OutMaterials, bool& OutHadErrors);
+  static bool LoadTextures(const FString& Path, TArray<RTexture>& OutTextures, bool& OutHadErrors);
+  static bool LoadDefaultMaterials(const FString& Path, TArray<RDefaultMaterials>& OutEntries, bool& OutHadErrors);
+  static bool LoadSpeedTreeOverrides(const FString& Path, TArray<RSpeedTreeOverride>& OutEntries, bool& OutHadErrors);
+
+  // Parse a part of MaterialsList.txt that starts at an entry. Used for dumps that arrive in parts.
+  // OutErrorLines are relative to Text. Returns the number of lines.
+  static int32 ParseMaterials(FAnsiStringView Text, TArray<RMaterial>& OutMaterials, TArray<int32>& OutErrorLines);
+
+  // Read and parse .cue files in parallel. Validation, preloading and import share the result.
+  static void ParseCues(const TArray<FString>& Files, TArray<FDumpCue>& OutCues);
+  // Parse the bytes of a .cue file that arrived without a file. Name is used in logs.
+  static void ParseCue(const FString& Name, TArray<uint8>&& Data, FDumpCue& OutCue);
+
+  // Map a whole dump. Gzip compressed dumps are inflated to OutText.Data.
+  static bool MapText(const FString& Path, FDumpText& OutText);
+  // Map or load a dump and split it to lines. Returns false if the file is missing or has no lines.
+  static bool LoadText(const FString& Path, FDumpText& OutText, bool bCullEmpty = true);
+  // Copy a dump line or field to an FString
+  static FString ToFString(FAnsiStringView Line);
+
+  // Path of the binary cache for the dump
+  static FString GetCachePath(const FString& Path);
+};
@@ -0,0 +1,164 @@
+#include "REDumpStream.h"
+
+#include "HAL/PlatformFileManager.h"
+#include "Hash/CityHash.h"
+
+THIRD_PARTY_INCLUDES_START
+#include "zlib.h"
+THIRD_PARTY_INCLUDES_END
+
+struct FDumpStream::FInflateState {
+  z_stream Stream = {};
+  bool bInitialized = false;
+  // Set while a gzip member is not fully inflated
+  bool bMemberOpen = false;
+
+  ~FInflateState()
+  {
+    if (bInitialized)
+    {
+      inflateEnd(&Stream);
+    }
+  }
+};
+
+FDumpStream::FDumpStream() = default;
+
+FDumpStream::~FDumpStream() = default;
+
+bool FDumpStream::Open(const FString& Path, FString& OutError)
+{
+  Handle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*Path));
+  if (!Handle)
+  {
+    OutError = FString::Printf(TEXT("Failed to open \"%s\"!"), *Path);
+    return false;
+  }
+  RawSize = Handle->Size();
+  if (!ReadRaw())
+  {
+    // Empty file
+    bEnd = true;
+    if (Error.Len())
+    {
+      OutError = Error;
+      return false;
+    }
+    return true;
+  }
+
+  const uint8* Magic = RawBuffer.GetData();
+  if (RawBuffer.Num() >= 2 && Magic[0] == 0x1F && Magic[1] == 0x8B)
+  {
+    bCompressed = true;
+    Inflate = MakeUnique<FInflateState>();
+    // 16 + MAX_WBITS: expect a gzip header and trailer
+    if (inflateInit2(&Inflate->Stream, 16 + MAX_WBITS) != Z_OK)
+    {
+      OutError = TEXT("Failed to initialize zlib!");
+      return false;
+    }
+    Inflate->bInitialized = true;
+    Inflate->bMemberOpen = true;
+  }
+  else if (RawBuffer.Num() >= 4 && Magic[0] == 0x28 && Magic[1] == 0xB5 && Magic[2] == 0x2F && Magic[3] == 0xFD)
+  {
+    OutError = FString::Printf(TEXT("\"%s\" is compressed with Zstandard. Only gzip compressed dumps are supported."), *Path);
+    return false;
+  }
+  return true;
+}
+
+int64 FDumpStream::Read(uint8* Dest, int64 Size)
+{
+  if (Error.Len() || !Handle)
+  {
+    return -1;
+  }
+
+  int64 Total = 0;
+  while (Total < Size && !bEnd)
+  {
+    if (RawPos == RawBuffer.Num() && !ReadRaw())
+    {
+      if (Error.Len())
+      {
+        return -1;
+      }
+      if (bCompressed && Inflate->bMemberOpen)
+      {
+        Error = TEXT("The compressed dump is truncated!");
+        return -1;
+      }
+      bEnd = true;
+      break;
+    }
+
+    if (!bCompressed)
+    {
+      const int32 Count = (int32)FMath::Min<int64>(Size - Total, RawBuffer.Num() - RawPos);
+      FMemory::Memcpy(Dest + Total, RawBuffer.GetData() + RawPos, Count);
+      RawPos += Count;
+      Total += Count;
+      continue;
+    }
+
+    z_stream& Stream = Inflate->Stream;
+    if (!Inflate->bMemberOpen)
+    {
+      // Concatenated gzip members
+      inflateReset(&Stream);
+      Inflate->bMemberOpen = true;
+    }
+    Stream.next_in = RawBuffer.GetData() + RawPos;
+    Stream.avail_in = (uInt)(RawBuffer.Num() - RawPos);
+    Stream.next_out = Dest + Total;
+    Stream.avail_out = (uInt)FMath::Min<int64>(Size - Total, MAX_uint32);
+    const int Ret = inflate(&Stream, Z_NO_FLUSH);
+    RawPos = RawBuffer.Num() - (int32)Stream.avail_in;
+    Total = Stream.next_out - Dest;
+    if (Ret == Z_STREAM_END)
+    {
+      Inflate->bMemberOpen = false;
+      if (RawPos == RawBuffer.Num() && RawRead == RawSize)
+      {
+        bEnd = true;
+      }
+    }
+    else if (Ret != Z_OK && Ret != Z_BUF_ERROR)
+    {
+      Error = FString::Printf(TEXT("Failed to inflate the dump: %s"), Stream.msg ? ANSI_TO_TCHAR(Stream.msg) : TEXT("corrupted data"));
+      return -1;
+    }
+  }
+  return Total;
+}
+
+uint64 FDumpStream::HashBytes(const uint8* Data, int64 Size)
+{
+  uint64 Hash = 0;
+  for (int64 Offset = 0; Offset < Size; Offset += BlockSize)
+  {
+    Hash = CityHash64WithSeed((const char*)Data + Offset, (uint32)FMath::Min(BlockSize, Size - Offset), Hash);
+  }
+  return Hash;
+}
+
+bool FDumpStream::ReadRaw()
+{
+  const int64 ToRead = FMath::Min(BlockSize, RawSize - RawRead);
+  if (ToRead <= 0)
+  {
+    return false;
+  }
+  RawBuffer.SetNumUninitialized((int32)ToRead, false);
+  if (!Handle->Read(RawBuffer.GetData(), ToRead))
+  {
+    Error = TEXT("Failed to read the dump!");
+    return false;
+  }
+  RawRead += ToRead;
+  RawPos = 0;
+  RawHash = CityHash64WithSeed((const char*)RawBuffer.GetData(), (uint32)ToRead, RawHash);
+  return true;
+}
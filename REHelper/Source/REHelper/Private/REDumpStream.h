@@ -0,0 +1,66 @@
+#pragma once
+#include "CoreMinimal.h"
+
+class IFileHandle;
+
+// Sequential reader of RE dump files. Gzip compressed dumps are inflated on the fly.
+class FDumpStream {
+public:
+  // Size of raw reads. Content hashes are chained over slices of this size.
+  static constexpr int64 BlockSize = 1024 * 1024;
+
+  FDumpStream();
+  ~FDumpStream();
+
+  // Open a dump. Returns false and sets OutError if the file can't be read or uses an unsupported compression.
+  bool Open(const FString& Path, FString& OutError);
+  // Read up to Size decompressed bytes. Returns the number of bytes read, 0 at the end of the dump or -1 on error.
+  int64 Read(uint8* Dest, int64 Size);
+
+  bool IsCompressed() const
+  {
+    return bCompressed;
+  }
+
+  // Size of the file on disk
+  int64 GetRawSize() const
+  {
+    return RawSize;
+  }
+
+  // Bytes read from the disk so far. Use it for progress.
+  int64 GetRawBytesRead() const
+  {
+    return RawRead;
+  }
+
+  // Hash of the raw bytes read so far. Equals HashBytes() of the whole file once the stream is exhausted.
+  uint64 GetRawHash() const
+  {
+    return RawHash;
+  }
+
+  const FString& GetError() const
+  {
+    return Error;
+  }
+
+  // Chained CityHash64 over BlockSize slices
+  static uint64 HashBytes(const uint8* Data, int64 Size);
+
+private:
+  bool ReadRaw();
+
+  struct FInflateState;
+
+  TUniquePtr<IFileHandle> Handle;
+  TUniquePtr<FInflateState> Inflate;
+  TArray<uint8> RawBuffer;
+  int32 RawPos = 0;
+  int64 RawSize = 0;
+  int64 RawRead = 0;
+  uint64 RawHash = 0;
+  bool bCompressed = false;
+  bool bEnd = false;
+  FString Error;
+};
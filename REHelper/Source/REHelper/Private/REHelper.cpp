@@ -2,13 +2,20 @@
 
 #include "REHelper.h"
 #include "REWorker.h"
+#include "RELiveIngest.h"
+#include "REImportBatch.h"
+#include "REImportCheckpoint.h"
+#include "REPackageSaver.h"
+#include "REShaderPrewarm.h"
 
 #include "Editor.h"
+#include "HAL/IConsoleManager.h"
 
 #include "REHelperStyle.h"
 #include "REHelperCommands.h"
 #include "Misc/MessageDialog.h"
 #include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
 #include "Modules/ModuleManager.h"
 #include "ContentBrowserModule.h"
 #include "ToolMenus.h"
@@ -27,6 +34,14 @@
 
 static const FName REHelperTabName("REHelper");
 
+namespace
+{
+  TAutoConsoleVariable<int32> CVarMaterialsUseTextures(
+    TEXT("REHelper.ImportMaterials.UseTextures"),
+    0,
+    TEXT("Pick sampler types from Textures.txt next to MaterialsList.txt instead of the current texture settings. Run Fix Textures before compiling the materials, or they won't match."));
+}
+
 #define LOCTEXT_NAMESPACE "FREHelperModule"
 
 void FREHelperModule::StartupModule()
@@ -47,6 +62,8 @@ void FREHelperModule::StartupModule()
 
 void FREHelperModule::ShutdownModule()
 {
+  RELiveIngest::Stop();
+  REShaderPrewarm::Shutdown();
   UToolMenus::UnRegisterStartupCallback(this);
   UToolMenus::UnregisterOwner(this);
   FREHelperStyle::Shutdown();
@@ -58,21 +75,41 @@ void FREHelperModule::OnImportMaterialsClicked()
   if (IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get())
   {
     TArray<FString> FilePaths;
-    FString Filter = TEXT("Real Editors materials|MaterialsList.txt");
+    FString Filter = TEXT("Real Editors materials|MaterialsList.txt;MaterialsList.txt.gz");
     if (DesktopPlatform->OpenFileDialog(nullptr, TEXT("Import Real Editor's material output..."), TEXT(""), TEXT("MaterialsList.txt"), Filter, EFileDialogFlags::None, FilePaths) && FilePaths.Num())
     {
-      FScopedTransaction Transaction(NSLOCTEXT("REHelper", "ImportMaterials", "Import Materials to Project"));
-      
+      // Real Editor saves Textures.txt next to the materials dump
+      FString TexturesPath;
+      if (CVarMaterialsUseTextures.GetValueOnGameThread())
+      {
+        for (const TCHAR* Name : { TEXT("Textures.txt"), TEXT("Textures.txt.gz") })
+        {
+          const FString Candidate = FPaths::GetPath(FilePaths[0]) / Name;
+          if (FPaths::FileExists(Candidate))
+          {
+            TexturesPath = Candidate;
+            break;
+          }
+        }
+      }
+
       FString ErrorMessage;
-      TArray<UObject*> Result = REWorker::ImportMaterials(FilePaths[0], ErrorMessage);
+      TArray<UObject*> Result;
+      {
+        // Closed before the dialog, so the report includes the save that waits for it
+        FScopedImportTransaction Transaction(NSLOCTEXT("REHelper", "ImportMaterials", "Import Materials to Project"));
+        Result = REWorker::ImportMaterials(FilePaths[0], ErrorMessage, TexturesPath);
+      }
+      // Batched imports unload most of what they create
+      const int32 NumImported = Result.Num() + REImportBatch::GetNumUnloaded();
       FText Title;
       FText Message;
-      if (Result.Num() < 0)
+      if (NumImported < 0)
       {
         Title = FText::FromString(TEXT("Error!"));
         Message = FText::FromString(ErrorMessage);
       }
-      else if (Result.Num() == 0)
+      else if (NumImported == 0)
       {
         if (ErrorMessage.Len())
         {
@@ -88,7 +125,7 @@ void FREHelperModule::OnImportMaterialsClicked()
       else
       {
         Title = FText::FromString(TEXT("Done!"));
-        Message = FText::FromString(FString::Printf(TEXT("Imported %d materials."), Result.Num()) + ErrorMessage);
+        Message = FText::FromString(FString::Printf(TEXT("Imported %d materials. "), NumImported) + REPackageSaver::GetLastReport() + ErrorMessage);
       }
       FMessageDialog::Open(EAppMsgType::Ok, Message, &Title);
     }
@@ -100,13 +137,15 @@ void FREHelperModule::OnAssignDefaultsClicked()
   if (IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get())
   {
     TArray<FString> FilePaths;
-    FString Filter = TEXT("Real Editors default materials|DefaultMaterials.txt");
+    FString Filter = TEXT("Real Editors default materials|DefaultMaterials.txt;DefaultMaterials.txt.gz");
     if (DesktopPlatform->OpenFileDialog(nullptr, TEXT("Open default materials map..."), TEXT(""), TEXT(""), Filter, EFileDialogFlags::None, FilePaths))
     {
-      FScopedTransaction Transaction(NSLOCTEXT("REHelper", "AssignDefaults", "Assign default materials to assets"));
-
       FString ErrorMessage;
-      int32 Num = REWorker::AssignDefaultMaterials(FilePaths[0], ErrorMessage);
+      int32 Num = 0;
+      {
+        FScopedImportTransaction Transaction(NSLOCTEXT("REHelper", "AssignDefaults", "Assign default materials to assets"));
+        Num = REWorker::AssignDefaultMaterials(FilePaths[0], ErrorMessage);
+      }
 
       FText Title;
       FText Message;
@@ -131,7 +170,7 @@ void FREHelperModule::OnAssignDefaultsClicked()
       else
       {
         Title = FText::FromString(TEXT("Done!"));
-        Message = FText::FromString(FString::Printf(TEXT("Processed %d assets."), Num) + ErrorMessage);
+        Message = FText::FromString(FString::Printf(TEXT("Processed %d assets. "), Num) + REPackageSaver::GetLastReport() + ErrorMessage);
       }
       FMessageDialog::Open(EAppMsgType::Ok, Message, &Title);
     }
@@ -162,22 +201,34 @@ void FREHelperModule::OnImportActorsClicked()
   if (IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get())
   {
     TArray<FString> OutFiles;
-    FString Filter = TEXT("T3D Level dump|*.t3d");
+    FString Filter = TEXT("T3D Level dump|*.t3d;*.t3d.gz");
     if (DesktopPlatform->OpenFileDialog(nullptr, TEXT("Import T3D Level dump"), TEXT(""), TEXT(""), Filter, EFileDialogFlags::None, OutFiles))
     {
-      FString Input;
-      FFileHelper::LoadFileToString(Input, *OutFiles[0]);
-      if (!Input.StartsWith(TEXT("BEGIN MAP")))
+      FString ErrorMessage;
+      int32 Num = 0;
       {
-        FText Title = FText::FromString(TEXT("Error!"));
-        FMessageDialog::Open(EAppMsgType::Ok, FText::FromString("The file is not a valid T3D file!"), &Title);
-        return;
+        FScopedImportTransaction Transaction(NSLOCTEXT("REHelper", "ImportActors", "Import Actors To Level"));
+        Num = REWorker::ImportActors(OutFiles[0], World, ErrorMessage);
       }
-      FScopedSlowTask Task(.0f, NSLOCTEXT("REHelper", "ImportingActors", "Importing actors..."));
-      Task.MakeDialog();
-      FScopedTransaction Transaction(NSLOCTEXT("REHelper", "ImportActors", "Import Actors To Level"));
-      GEditor->edactPasteSelected(GEditor->GetEditorWorldContext().World(), false, false, true, &Input);
-      GEditor->SelectNone(false, true, false);
+
+      FText Title;
+      FText Message;
+      if (Num < 0)
+      {
+        Title = FText::FromString(TEXT("Error!"));
+        Message = FText::FromString(ErrorMessage);
+      }
+      else if (Num == 0)
+      {
+        Title = FText::FromString(TEXT("Error!"));
+        Message = FText::FromString(ErrorMessage.Len() ? ErrorMessage : TEXT("The file has no actors!"));
+      }
+      else
+      {
+        Title = FText::FromString(TEXT("Done!"));
+        Message = FText::FromString(FString::Printf(TEXT("Imported %d actors. "), Num) + REPackageSaver::GetLastReport() + ErrorMessage);
+      }
+      FMessageDialog::Open(EAppMsgType::Ok, Message, &Title);
     }
   }
 }
@@ -187,12 +238,16 @@ void FREHelperModule::OnFixTexturesClicked()
   if (IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get())
   {
     TArray<FString> FilePaths;
-    FString Filter = TEXT("Real Editors textures|Textures.txt");
+    FString Filter = TEXT("Real Editors textures|Textures.txt;Textures.txt.gz");
     if (DesktopPlatform->OpenFileDialog(nullptr, TEXT("Open Real Editor's texture output..."), TEXT(""), TEXT("Textures.txt"), Filter, EFileDialogFlags::None, FilePaths) && FilePaths.Num())
     {
-      FScopedTransaction Transaction(NSLOCTEXT("REHelper", "FixTextures", "Fix imported textures"));
       FString ErrorMessage;
-      int32 Num = REWorker::FixTextures(FilePaths[0], ErrorMessage);
+      FString Stats;
+      int32 Num = 0;
+      {
+        FScopedImportTransaction Transaction(NSLOCTEXT("REHelper", "FixTextures", "Fix imported textures"));
+        Num = REWorker::FixTextures(FilePaths[0], ErrorMessage, &Stats);
+      }
 
       FText Title;
       FText Message;
@@ -217,7 +272,7 @@ void FREHelperModule::OnFixTexturesClicked()
       else
       {
         Title = FText::FromString(TEXT("Done!"));
-        Message = FText::FromString(FString::Printf(TEXT("Processed %d textures."), Num) + ErrorMessage);
+        Message = FText::FromString(FString::Printf(TEXT("Processed %d textures. "), Num) + Stats + TEXT(" ") + REPackageSaver::GetLastReport() + ErrorMessage);
       }
       FMessageDialog::Open(EAppMsgType::Ok, Message, &Title);
     }
@@ -248,7 +303,7 @@ void FREHelperModule::OnFixSpeedTreesClicked()
   if (IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get())
   {
     TArray<FString> OutFiles;
-    FString Filter = TEXT("SpeedTree Material Overrides|SpeedTreeOverrides.txt");
+    FString Filter = TEXT("SpeedTree Material Overrides|SpeedTreeOverrides.txt;SpeedTreeOverrides.txt.gz");
     if (DesktopPlatform->OpenFileDialog(nullptr, TEXT("Open SpeedTreeOverrides file"), TEXT(""), TEXT("SpeedTreeOverrides.txt"), Filter, EFileDialogFlags::None, OutFiles))
     {
       FString ErrorMessage;
@@ -277,7 +332,7 @@ void FREHelperModule::OnFixSpeedTreesClicked()
       else
       {
         Title = FText::FromString(TEXT("Done!"));
-        Message = FText::FromString(FString::Printf(TEXT("Processed %d actors. "), Num) + ErrorMessage);
+        Message = FText::FromString(FString::Printf(TEXT("Processed %d actors. "), Num) + REPackageSaver::GetLastReport() + ErrorMessage);
       }
       FMessageDialog::Open(EAppMsgType::Ok, Message, &Title);
     }
@@ -289,19 +344,23 @@ void FREHelperModule::OnImportCuesClicked()
   if (IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get())
   {
     TArray<FString> FilePaths;
-    FString Filter = TEXT("Real Editors cues|Cues.txt");
+    FString Filter = TEXT("Real Editors cues|Cues.txt;Cues.txt.gz");
     if (DesktopPlatform->OpenFileDialog(nullptr, TEXT("Open Real Editor's cues output..."), TEXT(""), TEXT("Cues.txt"), Filter, EFileDialogFlags::None, FilePaths) && FilePaths.Num())
     {
-      FScopedTransaction Transaction(NSLOCTEXT("REHelper", "ImportCues", "Importing CUEs"));
       FString ErrorMessage;
-      TArray<UObject*> Result = REWorker::ImportSoundCues(FilePaths[0], ErrorMessage);
-      if (Result.Num())
+      TArray<UObject*> Result;
+      {
+        FScopedImportTransaction Transaction(NSLOCTEXT("REHelper", "ImportCues", "Importing CUEs"));
+        Result = REWorker::ImportSoundCues(FilePaths[0], ErrorMessage);
+      }
+      const int32 NumImported = Result.Num() + REImportBatch::GetNumUnloaded();
+      if (NumImported)
       {
         /* May crash Editor
         IContentBrowserSingleton& ContentBrowser = FModuleManager::LoadModuleChecked<FContentBrowserModule>("ContentBrowser").Get();
         ContentBrowser.SyncBrowserToAssets(Result);*/
         FText Title = FText::FromString(TEXT("Done!"));
-        FMessageDialog::Open(EAppMsgType::Ok, FText::FromString(FString::Printf(TEXT("Imported %d CUEs"), Result.Num())), &Title);
+        FMessageDialog::Open(EAppMsgType::Ok, FText::FromString(FString::Printf(TEXT("Imported %d CUEs. "), NumImported) + REPackageSaver::GetLastReport()), &Title);
       }
       else if (ErrorMessage.Len())
       {
@@ -318,10 +377,10 @@ void FREHelperModule::OnImportSingleCueClicked()
   if (IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get())
   {
     TArray<FString> FilePaths;
-    FString Filter = TEXT("Real Editors Cue file|*.cue");
+    FString Filter = TEXT("Real Editors Cue file|*.cue;*.cue.gz");
     if (DesktopPlatform->OpenFileDialog(nullptr, TEXT("Open Real Editor's cue export..."), TEXT(""), TEXT("*.cue"), Filter, EFileDialogFlags::None, FilePaths) && FilePaths.Num())
     {
-      FScopedTransaction Transaction(NSLOCTEXT("REHelper", "ImportCue", "Importing a CUE"));
+      FScopedImportTransaction Transaction(NSLOCTEXT("REHelper", "ImportCue", "Importing a CUE"));
       FString ErrorMessage;
       if (UObject* Result = REWorker::ImportSingleCue(FilePaths[0], ErrorMessage))
       {
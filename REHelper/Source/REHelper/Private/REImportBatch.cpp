@@ -0,0 +1,205 @@
+#include "REImportBatch.h"
+#include "REAssetBatch.h"
+#include "REImportCheckpoint.h"
+#include "REPackageSaver.h"
+
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformMemory.h"
+#include "PackageTools.h"
+#include "ShaderCompiler.h"
+#include "UObject/UObjectGlobals.h"
+
+namespace
+{
+  TAutoConsoleVariable<int32> CVarBatchSize(
+    TEXT("REHelper.ImportBatch.Size"),
+    0,
+    TEXT("Save and unload imported assets every N created assets. 0 to keep everything loaded."));
+
+  TAutoConsoleVariable<int32> CVarBatchMemory(
+    TEXT("REHelper.ImportBatch.MemoryMB"),
+    0,
+    TEXT("Save and unload imported assets once the editor uses more physical memory than this. 0 for no limit."));
+
+  TAutoConsoleVariable<int32> CVarBatchMinSize(
+    TEXT("REHelper.ImportBatch.MinSize"),
+    64,
+    TEXT("Assets a batch needs before REHelper.ImportBatch.MemoryMB can end it. Keeps a high editor baseline from unloading after every asset."));
+
+  int32 BatchDepth = 0;
+  TArray<TWeakObjectPtr<UPackage>> PendingPackages;
+  // Existing packages the batch loaded, e.g. parents of unloaded batches and their textures. Unloaded with the batch.
+  TArray<TWeakObjectPtr<UPackage>> LoadedPackages;
+  FDelegateHandle LoadedHandle;
+  int32 NumPendingAssets = 0;
+  int32 NumUnloaded = 0;
+  // Memory use after the latest flush. The memory limit triggers again only once the import grows past it.
+  uint64 UsedAfterFlush = 0;
+
+  inline uint64 GetUsedMB()
+  {
+    return FPlatformMemory::GetStats().UsedPhysical / (1024 * 1024);
+  }
+
+  // Returns the packages that were saved
+  TArray<UPackage*> SavePending()
+  {
+    // The registry should know the assets before they are written
+    REAssetBatch::FlushPending();
+    TArray<UPackage*> Packages;
+    for (const TWeakObjectPtr<UPackage>& Package : PendingPackages)
+    {
+      if (Package.IsValid())
+      {
+        Packages.AddUnique(Package.Get());
+      }
+    }
+    PendingPackages.Reset();
+    NumPendingAssets = 0;
+    REPackageSaver::Save(Packages);
+    return Packages.FilterByPredicate([](const UPackage* Package) { return !Package->IsDirty(); });
+  }
+
+  void OnAssetLoaded(UObject* Asset)
+  {
+    if (Asset)
+    {
+      LoadedPackages.Add(Asset->GetOutermost());
+    }
+  }
+
+  // Loaded packages nobody edited. Packages of the batch itself are unloaded anyway.
+  TArray<UPackage*> TakeLoaded(const TSet<UPackage*>& Unloading)
+  {
+    TArray<UPackage*> Packages;
+    for (const TWeakObjectPtr<UPackage>& Package : LoadedPackages)
+    {
+      UPackage* Loaded = Package.Get();
+      if (Loaded && !Loaded->IsDirty() && !Loaded->ContainsMap() && !Unloading.Contains(Loaded))
+      {
+        Packages.AddUnique(Loaded);
+      }
+    }
+    LoadedPackages.Reset();
+    return Packages;
+  }
+
+  inline bool HasLimit()
+  {
+    return CVarBatchSize.GetValueOnGameThread() > 0 || CVarBatchMemory.GetValueOnGameThread() > 0;
+  }
+}
+
+bool REImportBatch::IsEnabled()
+{
+  return HasLimit() && REImportCheckpoint::IsFastImport();
+}
+
+void REImportBatch::OnAssetCreated(UObject* Asset)
+{
+  if (BatchDepth && IsEnabled())
+  {
+    PendingPackages.Add(Asset->GetOutermost());
+    NumPendingAssets++;
+  }
+}
+
+bool REImportBatch::ShouldFlush()
+{
+  if (!BatchDepth || !NumPendingAssets)
+  {
+    return false;
+  }
+  const int32 BatchSize = CVarBatchSize.GetValueOnGameThread();
+  if (BatchSize > 0 && NumPendingAssets >= BatchSize)
+  {
+    return true;
+  }
+  const int32 MemoryMB = CVarBatchMemory.GetValueOnGameThread();
+  if (MemoryMB <= 0 || NumPendingAssets < CVarBatchMinSize.GetValueOnGameThread())
+  {
+    return false;
+  }
+  const uint64 Used = GetUsedMB();
+  return Used >= (uint64)MemoryMB && Used > UsedAfterFlush;
+}
+
+void REImportBatch::Flush(TArray<UObject*>& InOutCreated)
+{
+  if (!NumPendingAssets)
+  {
+    return;
+  }
+  const double StartTime = FPlatformTime::Seconds();
+  const uint64 UsedBefore = GetUsedMB();
+  // Materials can't be unloaded while their shaders are compiled
+  if (GShaderCompilingManager && GShaderCompilingManager->IsCompiling())
+  {
+    GShaderCompilingManager->FinishAllCompilation();
+  }
+  TArray<UPackage*> Packages = SavePending();
+  const int32 NumSaved = Packages.Num();
+  TSet<UPackage*> Unloading(Packages);
+  const int32 NumCreated = InOutCreated.Num();
+  InOutCreated.RemoveAll([&Unloading](const UObject* Object) { return Unloading.Contains(Object->GetOutermost()); });
+  NumUnloaded += NumCreated - InOutCreated.Num();
+  Packages.Append(TakeLoaded(Unloading));
+  if (!Packages.Num())
+  {
+    return;
+  }
+
+  // Unloads the packages and collects garbage
+  FText Error;
+  if (!UPackageTools::UnloadPackages(Packages, Error))
+  {
+    UE_LOG(LogTemp, Warning, TEXT("RE Helper: Failed to unload imported packages: %s"), *Error.ToString());
+  }
+  UsedAfterFlush = GetUsedMB();
+  UE_LOG(LogTemp, Display, TEXT("RE Helper: Saved %d and unloaded %d packages in %.2f s. Memory: %llu MB -> %llu MB"), NumSaved, Packages.Num(), FPlatformTime::Seconds() - StartTime, UsedBefore, UsedAfterFlush);
+  const int32 MemoryMB = CVarBatchMemory.GetValueOnGameThread();
+  if (MemoryMB > 0 && UsedAfterFlush >= (uint64)MemoryMB)
+  {
+    UE_LOG(LogTemp, Warning, TEXT("RE Helper: The editor still uses %llu MB after unloading a batch, more than REHelper.ImportBatch.MemoryMB %d. The next batch ends once memory grows past that."), UsedAfterFlush, MemoryMB);
+  }
+}
+
+int32 REImportBatch::GetNumUnloaded()
+{
+  return NumUnloaded;
+}
+
+void REImportBatch::Begin()
+{
+  if (!BatchDepth++)
+  {
+    NumUnloaded = 0;
+    UsedAfterFlush = 0;
+    if (HasLimit() && !REImportCheckpoint::IsFastImport())
+    {
+      UE_LOG(LogTemp, Warning, TEXT("RE Helper: REHelper.ImportBatch needs REHelper.FastImport 1. Importing without batches."));
+    }
+    else if (IsEnabled())
+    {
+      LoadedHandle = FCoreUObjectDelegates::OnAssetLoaded.AddStatic(&OnAssetLoaded);
+    }
+  }
+}
+
+void REImportBatch::End()
+{
+  if (--BatchDepth)
+  {
+    return;
+  }
+  if (LoadedHandle.IsValid())
+  {
+    FCoreUObjectDelegates::OnAssetLoaded.Remove(LoadedHandle);
+    LoadedHandle.Reset();
+  }
+  LoadedPackages.Empty();
+  if (NumPendingAssets)
+  {
+    SavePending();
+  }
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "CoreMinimal.h"
+
+// Keeps long imports within a memory budget. Assets created while an FScopedImportBatch is alive are saved,
+// unloaded and garbage collected every REHelper.ImportBatch.Size assets, or whenever the editor uses more than
+// REHelper.ImportBatch.MemoryMB of physical memory. Disabled while both are 0. Existing assets the batch loaded,
+// like parents from earlier batches and their textures, are unloaded with it.
+// Unloaded objects can't stay in the undo buffer, so batches are only made during a fast import (see REImportCheckpoint).
+class REImportBatch {
+public:
+  REImportBatch() = delete;
+  ~REImportBatch() = delete;
+
+  // One of the limits is set and REHelper.FastImport is on
+  static bool IsEnabled();
+
+  // Remember a created asset. Its package is saved and unloaded by the next Flush.
+  static void OnAssetCreated(UObject* Asset);
+  // True once the batch size is reached, or the memory ceiling is exceeded by a batch of at least REHelper.ImportBatch.MinSize
+  // assets while memory has grown since the last flush
+  static bool ShouldFlush();
+  // Save and unload the created packages and collect garbage. Callers must drop their pointers to created objects first.
+  // Unloaded objects are removed from InOutCreated.
+  static void Flush(TArray<UObject*>& InOutCreated);
+
+  // Assets unloaded since the outermost scope began. They are not in the importer's result anymore.
+  static int32 GetNumUnloaded();
+
+private:
+  friend struct FScopedImportBatch;
+
+  static void Begin();
+  static void End();
+};
+
+// Collects created assets for REImportBatch. Saves the last batch without unloading it. Scopes can be nested.
+struct FScopedImportBatch {
+  FScopedImportBatch()
+  {
+    REImportBatch::Begin();
+  }
+
+  ~FScopedImportBatch()
+  {
+    REImportBatch::End();
+  }
+
+  FScopedImportBatch(const FScopedImportBatch&) = delete;
+  FScopedImportBatch& operator=(const FScopedImportBatch&) = delete;
+};
@@ -0,0 +1,202 @@
+#include "REImportCheckpoint.h"
+#include "REPackageSaver.h"
+
+#include "Editor.h"
+#include "Editor/Transactor.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "ObjectTools.h"
+#include "PackageTools.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectHash.h"
+
+namespace
+{
+  TAutoConsoleVariable<int32> CVarFastImport(
+    TEXT("REHelper.FastImport"),
+    0,
+    TEXT("Don't record imports in the undo buffer. REHelper.RevertImport undoes the latest import by deleting the packages it created and reloading the ones it modified."));
+
+  struct FCheckpoint {
+    FText Description;
+    // Packages that didn't exist on disk. Names, since batched imports unload them.
+    TArray<FString> Created;
+    // Packages on disk that were clean before the import
+    TArray<FString> Dirtied;
+    TSet<FName> Seen;
+  };
+
+  TUniquePtr<FCheckpoint> Checkpoint;
+  int32 Depth = 0;
+  FDelegateHandle DirtyHandle;
+
+  // Fires for MarkPackageDirty and SetDirtyFlag. Packages that were dirty before the import don't change state.
+  void OnDirtyStateChanged(UPackage* Package)
+  {
+    if (!Checkpoint || !Package || !Package->IsDirty() || Package == GetTransientPackage())
+    {
+      return;
+    }
+    bool bSeen = false;
+    Checkpoint->Seen.Add(Package->GetFName(), &bSeen);
+    if (bSeen)
+    {
+      return;
+    }
+    if (!FPackageName::DoesPackageExist(Package->GetName()))
+    {
+      Checkpoint->Created.Add(Package->GetName());
+    }
+    else
+    {
+      Checkpoint->Dirtied.Add(Package->GetName());
+    }
+  }
+
+  FString GetListPath()
+  {
+    return FPaths::ProjectSavedDir() / TEXT("REHelper") / TEXT("LastImport.txt");
+  }
+
+  // Plain list of the checkpoint for people who want to clean up by hand
+  void SaveList()
+  {
+    FString Text = Checkpoint->Description.ToString() + TEXT("\n");
+    for (const FString& Name : Checkpoint->Created)
+    {
+      Text += TEXT("Created ") + Name + TEXT("\n");
+    }
+    for (const FString& Name : Checkpoint->Dirtied)
+    {
+      Text += TEXT("Modified ") + Name + TEXT("\n");
+    }
+    FFileHelper::SaveStringToFile(Text, *GetListPath());
+  }
+
+  void RevertCommand()
+  {
+    FString Error;
+    if (!REImportCheckpoint::Revert(Error))
+    {
+      UE_LOG(LogTemp, Error, TEXT("RE Helper: %s"), *Error);
+    }
+  }
+
+  FAutoConsoleCommand RevertImportCommand(
+    TEXT("REHelper.RevertImport"),
+    TEXT("Undo the latest import made with REHelper.FastImport"),
+    FConsoleCommandDelegate::CreateStatic(&RevertCommand));
+}
+
+bool REImportCheckpoint::IsFastImport()
+{
+  return CVarFastImport.GetValueOnGameThread() != 0;
+}
+
+bool REImportCheckpoint::HasCheckpoint()
+{
+  return Checkpoint.IsValid() && !Depth;
+}
+
+void REImportCheckpoint::Begin(const FText& Description)
+{
+  if (Depth++)
+  {
+    return;
+  }
+  // Undo history can't be replayed over changes it didn't see
+  if (GEditor && GEditor->Trans)
+  {
+    GEditor->Trans->Reset(Description);
+  }
+  Checkpoint = MakeUnique<FCheckpoint>();
+  Checkpoint->Description = Description;
+  DirtyHandle = UPackage::PackageDirtyStateChangedEvent.AddStatic(&OnDirtyStateChanged);
+}
+
+void REImportCheckpoint::End()
+{
+  if (--Depth)
+  {
+    return;
+  }
+  UPackage::PackageDirtyStateChangedEvent.Remove(DirtyHandle);
+  DirtyHandle.Reset();
+  SaveList();
+  UE_LOG(LogTemp, Display, TEXT("RE Helper: %s created %d and modified %d packages without undo. Run REHelper.RevertImport to revert it."), *Checkpoint->Description.ToString(), Checkpoint->Created.Num(), Checkpoint->Dirtied.Num());
+}
+
+bool REImportCheckpoint::Revert(FString& OutError)
+{
+  if (!HasCheckpoint())
+  {
+    OutError = TEXT("There is no fast import to revert.");
+    return false;
+  }
+  TUniquePtr<FCheckpoint> Reverted = MoveTemp(Checkpoint);
+
+  TArray<UObject*> Assets;
+  for (const FString& Name : Reverted->Created)
+  {
+    // Batched imports saved and unloaded their packages. Load them back to delete the files too.
+    UPackage* Package = FindPackage(nullptr, *Name);
+    if (!Package && FPackageName::DoesPackageExist(Name))
+    {
+      Package = LoadPackage(nullptr, *Name, LOAD_None);
+    }
+    if (Package)
+    {
+      TArray<UObject*> Objects;
+      GetObjectsWithOuter(Package, Objects, false);
+      Assets.Append(Objects.FilterByPredicate([](const UObject* Object) { return Object->IsAsset(); }));
+    }
+  }
+  const int32 NumDeleted = Assets.Num() ? ObjectTools::ForceDeleteObjects(Assets, false) : 0;
+
+  TArray<UPackage*> Packages;
+  for (const FString& Name : Reverted->Dirtied)
+  {
+    UPackage* Package = FindPackage(nullptr, *Name);
+    if (Package && Package->IsDirty())
+    {
+      Packages.Add(Package);
+    }
+  }
+  FText ReloadError;
+  const bool bReloaded = !Packages.Num() || UPackageTools::ReloadPackages(Packages, ReloadError, EReloadPackagesInteractionMode::AssumePositive);
+  IFileManager::Get().Delete(*GetListPath());
+
+  UE_LOG(LogTemp, Display, TEXT("RE Helper: Reverted %s: deleted %d of %d assets, reloaded %d packages"), *Reverted->Description.ToString(), NumDeleted, Assets.Num(), Packages.Num());
+  if (NumDeleted != Assets.Num() || !bReloaded)
+  {
+    OutError = TEXT("Some changes couldn't be reverted. ") + ReloadError.ToString();
+    return false;
+  }
+  return true;
+}
+
+FScopedImportTransaction::FScopedImportTransaction(const FText& Description)
+{
+  if (REImportCheckpoint::IsFastImport())
+  {
+    REImportCheckpoint::Begin(Description);
+  }
+  else
+  {
+    Transaction = MakeUnique<FScopedTransaction>(Description);
+  }
+}
+
+FScopedImportTransaction::~FScopedImportTransaction()
+{
+  if (!Transaction)
+  {
+    REImportCheckpoint::End();
+  }
+  // Close the transaction before the import is saved
+  Transaction.Reset();
+  REPackageSaver::SaveDeferred();
+}
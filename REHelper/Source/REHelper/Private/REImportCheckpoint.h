@@ -0,0 +1,36 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "ScopedTransaction.h"
+
+// Package-level undo for imports made with REHelper.FastImport.
+// Instead of recording every created and modified object in the transaction buffer, a checkpoint lists the packages
+// an import created or dirtied. REHelper.RevertImport deletes the created ones and reloads the dirtied ones from disk.
+class REImportCheckpoint {
+public:
+  REImportCheckpoint() = delete;
+  ~REImportCheckpoint() = delete;
+
+  static bool IsFastImport();
+
+  // Undo the latest fast import. Returns false if there's nothing to revert or reverting failed.
+  static bool Revert(FString& OutError);
+  static bool HasCheckpoint();
+
+private:
+  friend struct FScopedImportTransaction;
+
+  static void Begin(const FText& Description);
+  static void End();
+};
+
+// An FScopedTransaction, or a checkpoint if REHelper.FastImport is set
+struct FScopedImportTransaction {
+  FScopedImportTransaction(const FText& Description);
+  ~FScopedImportTransaction();
+
+  FScopedImportTransaction(const FScopedImportTransaction&) = delete;
+  FScopedImportTransaction& operator=(const FScopedImportTransaction&) = delete;
+
+private:
+  TUniquePtr<FScopedTransaction> Transaction;
+};
@@ -0,0 +1,601 @@
+#include "RELiveIngest.h"
+#include "REDump.h"
+#include "REDumpStream.h"
+#include "REPackageSaver.h"
+#include "REResolver.h"
+#include "REScanner.h"
+#include "REStreamImport.h"
+#include "REWorker.h"
+
+#include "Async/Async.h"
+#include "Common/TcpListener.h"
+#include "Common/TcpSocketBuilder.h"
+#include "Containers/Queue.h"
+#include "Containers/Ticker.h"
+#include "Editor.h"
+#include "Framework/Notifications/NotificationManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Interfaces/IPv4/IPv4Address.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+#include "Misc/FileHelper.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "Widgets/Notifications/SNotificationList.h"
+
+namespace
+{
+  TAutoConsoleVariable<int32> CVarIngestPort(
+    TEXT("REHelper.Ingest.Port"),
+    28015,
+    TEXT("Loopback TCP port of the live dump listener."));
+
+  TAutoConsoleVariable<float> CVarIngestTickBudget(
+    TEXT("REHelper.Ingest.TickBudgetMs"),
+    30.f,
+    TEXT("Time per editor tick spent on creating assets from a live dump."));
+
+  TAutoConsoleVariable<float> CVarReplayRate(
+    TEXT("REHelper.Ingest.ReplayRate"),
+    0.f,
+    TEXT("Throttle REHelper.Ingest.Replay to this many MB/s to mimic a slow exporter. 0 sends as fast as possible."));
+
+  // Bytes received per Recv call and per editor tick
+  const int32 RecvBlockSize = 256 * 1024;
+  const int32 MaxBytesPerTick = 8 * 1024 * 1024;
+  // Longest valid first line
+  const int32 MaxHeaderSize = 64;
+  // Largest .cue file sent inline
+  const int64 MaxCueSize = 16 * 1024 * 1024;
+
+  enum class EIngestKind : uint8 {
+    Unknown,
+    Materials,
+    Cues,
+    T3D
+  };
+
+  EIngestKind ParseKind(FAnsiStringView Kind)
+  {
+    if (Kind == "Materials")
+    {
+      return EIngestKind::Materials;
+    }
+    if (Kind == "Cues")
+    {
+      return EIngestKind::Cues;
+    }
+    if (Kind == "T3D")
+    {
+      return EIngestKind::T3D;
+    }
+    return EIngestKind::Unknown;
+  }
+
+  // A cue of a live dump. Parsed if its file was sent inline, a path to read otherwise.
+  struct FLiveCue {
+    FString Path;
+    TUniquePtr<FDumpCue> Parsed;
+  };
+
+  // A single connection. Bytes are parsed as soon as complete entries arrive.
+  class FIngestSession {
+  public:
+    FIngestSession(FSocket* InSocket, const FIPv4Endpoint& InPeer)
+      : Socket(InSocket)
+      , Peer(InPeer.ToString())
+      , StartTime(FPlatformTime::Seconds())
+    {
+      Socket->SetNonBlocking(true);
+      PackageSave.Emplace();
+      UE_LOG(LogTemp, Display, TEXT("RE Helper: Live ingestion connection from %s"), *Peer);
+    }
+
+    ~FIngestSession()
+    {
+      Socket->Close();
+      ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+    }
+
+    // Returns false when the session is over
+    bool Tick()
+    {
+      if (!bClosed)
+      {
+        bClosed = !Receive();
+      }
+      if (Kind == EIngestKind::Unknown && !ReadHeader())
+      {
+        if (bFailed || bClosed)
+        {
+          UE_LOG(LogTemp, Error, TEXT("RE Helper: Live ingestion from %s has no valid header. Expected \"Materials\", \"Cues\" or \"T3D\" on the first line."), *Peer);
+          return false;
+        }
+        return true;
+      }
+
+      ProcessBuffer(bClosed);
+      if (bFailed)
+      {
+        Finish();
+        return false;
+      }
+
+      const double TimeLimit = CVarIngestTickBudget.GetValueOnGameThread() / 1000.;
+      bool bIdle = true;
+      if (Materials)
+      {
+        bIdle = Materials->Process(TimeLimit);
+      }
+      else if (Kind == EIngestKind::Cues)
+      {
+        bIdle = ImportCues(TimeLimit);
+      }
+
+      if (bClosed && bIdle)
+      {
+        Finish();
+        return false;
+      }
+      return true;
+    }
+
+  private:
+    // Returns false once the peer closed the connection
+    bool Receive()
+    {
+      for (int32 Total = 0; Total < MaxBytesPerTick;)
+      {
+        const int32 Offset = Buffer.Num();
+        Buffer.AddUninitialized(RecvBlockSize);
+        int32 Read = 0;
+        const bool bOk = Socket->Recv(Buffer.GetData() + Offset, RecvBlockSize, Read);
+        Buffer.SetNum(Offset + Read, false);
+        Total += Read;
+        BytesReceived += Read;
+        if (!bOk)
+        {
+          return false;
+        }
+        if (!Read)
+        {
+          // Nothing to read yet
+          break;
+        }
+      }
+      return true;
+    }
+
+    bool ReadHeader()
+    {
+      const ANSICHAR* Begin = (const ANSICHAR*)Buffer.GetData();
+      const ANSICHAR* End = Begin + Buffer.Num();
+      const ANSICHAR* Eol = REScanner::FindChar(Begin, End, '\n');
+      if (Eol == End)
+      {
+        bFailed = Buffer.Num() > MaxHeaderSize;
+        return false;
+      }
+      Kind = ParseKind(FAnsiStringView(Begin, (int32)(Eol - Begin)).TrimStartAndEnd());
+      if (Kind == EIngestKind::Unknown)
+      {
+        bFailed = true;
+        return false;
+      }
+
+      int32 Consumed = (int32)(Eol - Begin) + 1;
+      if (Buffer.Num() - Consumed >= 3 && Buffer[Consumed] == 0xEF && Buffer[Consumed + 1] == 0xBB && Buffer[Consumed + 2] == 0xBF)
+      {
+        Consumed += 3;
+      }
+      Buffer.RemoveAt(0, Consumed, false);
+
+      if (Kind == EIngestKind::Materials)
+      {
+        Materials = MakeUnique<FMaterialStreamImporter>();
+      }
+      else if (Kind == EIngestKind::T3D)
+      {
+        Actors = MakeUnique<FT3DChunkImporter>(GEditor->GetEditorWorldContext().World(), REWorker::GetT3DActorsPerChunk());
+      }
+      return true;
+    }
+
+    // Parse complete entries. The rest stays in the Buffer until more bytes arrive.
+    void ProcessBuffer(bool bFinal)
+    {
+      if (Kind == EIngestKind::Cues)
+      {
+        ProcessCues(bFinal);
+        return;
+      }
+      const ANSICHAR* Begin = (const ANSICHAR*)Buffer.GetData();
+      const ANSICHAR* End = Begin + Buffer.Num();
+      const ANSICHAR* Cut = End;
+      if (!bFinal)
+      {
+        if (Kind == EIngestKind::Materials)
+        {
+          // The last entry may miss some of its parameters
+          Cut = REScanner::FindLastEntryStart(Begin, End);
+        }
+        else
+        {
+          Cut = End;
+          while (Cut > Begin && Cut[-1] != '\n')
+          {
+            Cut--;
+          }
+        }
+      }
+      if (Cut == Begin)
+      {
+        return;
+      }
+
+      const FAnsiStringView Text(Begin, (int32)(Cut - Begin));
+      if (Kind == EIngestKind::Materials)
+      {
+        TArray<RMaterial> Parsed;
+        TArray<int32> ErrorLines;
+        const int32 NumLines = REDump::ParseMaterials(Text, Parsed, ErrorLines);
+        for (int32 ErrorLine : ErrorLines)
+        {
+          UE_LOG(LogTemp, Error, TEXT("RE Helper: Failed to parse entry at line %d of the live dump from %s"), LineOffset + ErrorLine + 1, *Peer);
+          bErrors = true;
+        }
+        LineOffset += NumLines;
+        Materials->Add(MoveTemp(Parsed));
+      }
+      else
+      {
+        TArray<FAnsiStringView> Lines;
+        REScanner::SplitLines(Begin, Cut, Lines, false);
+        for (const FAnsiStringView& Line : Lines)
+        {
+          if (!Actors->AddLine(Line))
+          {
+            UE_LOG(LogTemp, Error, TEXT("RE Helper: Live dump from %s is not a valid T3D!"), *Peer);
+            bFailed = true;
+            break;
+          }
+        }
+      }
+      Buffer.RemoveAt(0, (int32)(Cut - Begin), false);
+    }
+
+    // A cue record is "<Name>\t<Size>" on a line followed by Size bytes of a .cue file.
+    // A line without a size is the path of a .cue file on disk, like the lines of Cues.txt.
+    void ProcessCues(bool bFinal)
+    {
+      const ANSICHAR* Begin = (const ANSICHAR*)Buffer.GetData();
+      const ANSICHAR* End = Begin + Buffer.Num();
+      const ANSICHAR* Ptr = Begin;
+      while (Ptr < End)
+      {
+        const ANSICHAR* Eol = REScanner::FindChar(Ptr, End, '\n');
+        if (Eol == End && !bFinal)
+        {
+          break;
+        }
+        FAnsiStringView Line(Ptr, (int32)(Eol - Ptr));
+        if (Line.EndsWith('\r'))
+        {
+          Line = Line.LeftChop(1);
+        }
+        const ANSICHAR* Next = Eol < End ? Eol + 1 : End;
+        int32 Tab = INDEX_NONE;
+        if (Line.FindChar(REDumpCore::VSEP_CHAR, Tab))
+        {
+          const FAnsiStringView SizeText = Line.RightChop(Tab + 1);
+          int64 Size = SizeText.Len() ? 0 : -1;
+          for (int32 Idx = 0; Idx < SizeText.Len() && Size >= 0; ++Idx)
+          {
+            Size = FChar::IsDigit(SizeText[Idx]) && Size <= MaxCueSize ? Size * 10 + (SizeText[Idx] - '0') : -1;
+          }
+          if (Size < 0 || Size > MaxCueSize)
+          {
+            UE_LOG(LogTemp, Error, TEXT("RE Helper: Live cue record \"%s\" from %s has no valid size"), *REDump::ToFString(Line), *Peer);
+            bFailed = true;
+            break;
+          }
+          if (End - Next < Size)
+          {
+            if (bFinal)
+            {
+              UE_LOG(LogTemp, Error, TEXT("RE Helper: Live cue \"%s\" from %s is truncated"), *REDump::ToFString(Line.Left(Tab)), *Peer);
+              bFailed = true;
+            }
+            break;
+          }
+          FLiveCue& Cue = Cues.AddDefaulted_GetRef();
+          Cue.Path = REDump::ToFString(Line.Left(Tab));
+          Cue.Parsed = MakeUnique<FDumpCue>();
+          REDump::ParseCue(Cue.Path, TArray<uint8>((const uint8*)Next, (int32)Size), *Cue.Parsed);
+          Next += Size;
+        }
+        else if (Line.Len() > 2 && !Line.StartsWith(' '))
+        {
+          Cues.AddDefaulted_GetRef().Path = REDump::ToFString(Line);
+        }
+        Ptr = Next;
+      }
+      Buffer.RemoveAt(0, (int32)(Ptr - Begin), false);
+    }
+
+    // Returns true if all received cues are imported
+    bool ImportCues(double TimeLimit)
+    {
+      const double EndTime = FPlatformTime::Seconds() + TimeLimit;
+      for (; NextCue < Cues.Num() && FPlatformTime::Seconds() < EndTime; ++NextCue)
+      {
+        FString Error;
+        const FLiveCue& Cue = Cues[NextCue];
+        if (Cue.Parsed ? REWorker::ImportSingleCue(*Cue.Parsed, Error) : REWorker::ImportSingleCue(Cue.Path, Error))
+        {
+          NumCreated++;
+        }
+        else
+        {
+          bErrors = true;
+        }
+      }
+      return NextCue == Cues.Num();
+    }
+
+    void Finish()
+    {
+      if (Materials)
+      {
+        Materials->Finish();
+        NumCreated = Materials->GetCreated().Num();
+        bErrors |= Materials->HadErrors();
+      }
+      else if (Actors)
+      {
+        if (!bFailed)
+        {
+          Actors->Flush();
+        }
+        NumCreated = Actors->GetNumActors();
+      }
+
+      // Everything the session created is saved as one batch
+      PackageSave.Reset();
+      const double Seconds = FPlatformTime::Seconds() - StartTime;
+      FString Message = FString::Printf(TEXT("Live import from %s: %d %s in %.1f s%s"), *Peer, NumCreated, Actors ? TEXT("actors") : TEXT("assets"), Seconds, bErrors || bFailed ? TEXT(". Some errors occured. See the Output Log for details.") : TEXT(""));
+      const FString SaveReport = REPackageSaver::GetLastReport();
+      if (SaveReport.Len())
+      {
+        Message += TEXT(" ") + SaveReport;
+      }
+      UE_LOG(LogTemp, Display, TEXT("RE Helper: %s (%lld bytes)"), *Message, BytesReceived);
+      FNotificationInfo Info(FText::FromString(Message));
+      Info.ExpireDuration = 5.f;
+      FSlateNotificationManager::Get().AddNotification(Info);
+    }
+
+    FSocket* Socket = nullptr;
+    FString Peer;
+    double StartTime = 0.;
+    EIngestKind Kind = EIngestKind::Unknown;
+    TArray<uint8> Buffer;
+    int64 BytesReceived = 0;
+    int32 LineOffset = 0;
+    int32 NumCreated = 0;
+    bool bClosed = false;
+    bool bFailed = false;
+    bool bErrors = false;
+
+    TUniquePtr<FMaterialStreamImporter> Materials;
+    TUniquePtr<FT3DChunkImporter> Actors;
+    TArray<FLiveCue> Cues;
+    int32 NextCue = 0;
+    // Materials and cues of a dump share textures and waves
+    FScopedResolverCache ResolverCache;
+    // Outermost save scope of everything the session imports. Ends in Finish, or with the session if it fails early.
+    TOptional<FScopedPackageSave> PackageSave;
+  };
+
+  FSocket* ListenSocket = nullptr;
+  TUniquePtr<FTcpListener> Listener;
+  // Accepted on the listener thread, served on the game thread
+  TQueue<TPair<FSocket*, FIPv4Endpoint>, EQueueMode::Mpsc> PendingConnections;
+  TUniquePtr<FIngestSession> Session;
+  FDelegateHandle TickerHandle;
+
+  bool Tick(float)
+  {
+    if (!Session)
+    {
+      TPair<FSocket*, FIPv4Endpoint> Connection;
+      if (!PendingConnections.Dequeue(Connection))
+      {
+        return true;
+      }
+      Session = MakeUnique<FIngestSession>(Connection.Key, Connection.Value);
+    }
+    if (!Session->Tick())
+    {
+      Session.Reset();
+    }
+    return true;
+  }
+
+  void StartCommand()
+  {
+    FString Error;
+    if (!RELiveIngest::Start(Error))
+    {
+      UE_LOG(LogTemp, Error, TEXT("RE Helper: %s"), *Error);
+    }
+  }
+
+  void ReplayCommand(const TArray<FString>& Args)
+  {
+    if (Args.Num() < 2)
+    {
+      UE_LOG(LogTemp, Warning, TEXT("RE Helper: Usage: REHelper.Ingest.Replay <Materials|Cues|T3D> <Path to a dump file>"));
+      return;
+    }
+    RELiveIngest::Replay(Args[0], Args[1]);
+  }
+
+  FAutoConsoleCommand StartIngestCommand(
+    TEXT("REHelper.Ingest.Start"),
+    TEXT("Listen for live RE dumps on 127.0.0.1:REHelper.Ingest.Port"),
+    FConsoleCommandDelegate::CreateStatic(&StartCommand));
+
+  FAutoConsoleCommand StopIngestCommand(
+    TEXT("REHelper.Ingest.Stop"),
+    TEXT("Stop listening for live RE dumps"),
+    FConsoleCommandDelegate::CreateStatic(&RELiveIngest::Stop));
+
+  FAutoConsoleCommand ReplayIngestCommand(
+    TEXT("REHelper.Ingest.Replay"),
+    TEXT("Send a dump file to the live dump listener. Usage: REHelper.Ingest.Replay <Materials|Cues|T3D> <Path to a dump file>"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&ReplayCommand));
+}
+
+bool RELiveIngest::Start(FString& OutError)
+{
+  if (IsRunning())
+  {
+    return true;
+  }
+  const FIPv4Endpoint Endpoint(FIPv4Address::InternalLoopback, (uint16)CVarIngestPort.GetValueOnGameThread());
+  ListenSocket = FTcpSocketBuilder(TEXT("REHelper live ingestion")).AsReusable().BoundToEndpoint(Endpoint).Listening(1);
+  if (!ListenSocket)
+  {
+    OutError = FString::Printf(TEXT("Failed to listen on %s. Is the port in use?"), *Endpoint.ToString());
+    return false;
+  }
+  Listener = MakeUnique<FTcpListener>(*ListenSocket, FTimespan::FromMilliseconds(100));
+  Listener->OnConnectionAccepted().BindLambda([](FSocket* Socket, const FIPv4Endpoint& Peer) {
+    PendingConnections.Enqueue(TPair<FSocket*, FIPv4Endpoint>(Socket, Peer));
+    return true;
+  });
+  TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&Tick));
+  UE_LOG(LogTemp, Display, TEXT("RE Helper: Waiting for live dumps on %s"), *Endpoint.ToString());
+  return true;
+}
+
+void RELiveIngest::Stop()
+{
+  if (!IsRunning())
+  {
+    return;
+  }
+  FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+  TickerHandle.Reset();
+  // Stops the listener thread. The socket isn't owned by the listener.
+  Listener.Reset();
+  ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+  SocketSubsystem->DestroySocket(ListenSocket);
+  ListenSocket = nullptr;
+  Session.Reset();
+  TPair<FSocket*, FIPv4Endpoint> Connection;
+  while (PendingConnections.Dequeue(Connection))
+  {
+    SocketSubsystem->DestroySocket(Connection.Key);
+  }
+  UE_LOG(LogTemp, Display, TEXT("RE Helper: Stopped waiting for live dumps"));
+}
+
+bool RELiveIngest::IsRunning()
+{
+  return Listener.IsValid();
+}
+
+void RELiveIngest::Replay(const FString& Kind, const FString& Path)
+{
+  const FIPv4Endpoint Endpoint(FIPv4Address::InternalLoopback, (uint16)CVarIngestPort.GetValueOnGameThread());
+  const float Rate = CVarReplayRate.GetValueOnGameThread();
+  Async(EAsyncExecution::Thread, [Kind, Path, Endpoint, Rate] {
+    FDumpStream Stream;
+    FString Error;
+    if (!Stream.Open(Path, Error))
+    {
+      UE_LOG(LogTemp, Error, TEXT("RE Helper: Replay: %s"), *Error);
+      return;
+    }
+    ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+    FSocket* Socket = FTcpSocketBuilder(TEXT("REHelper replay")).AsBlocking();
+    if (!Socket || !Socket->Connect(*Endpoint.ToInternetAddr()))
+    {
+      UE_LOG(LogTemp, Error, TEXT("RE Helper: Replay: Failed to connect to %s. Run REHelper.Ingest.Start first."), *Endpoint.ToString());
+      SocketSubsystem->DestroySocket(Socket);
+      return;
+    }
+
+    auto SendAll = [Socket](const uint8* Data, int32 Size) {
+      while (Size > 0)
+      {
+        int32 Sent = 0;
+        if (!Socket->Send(Data, Size, Sent))
+        {
+          return false;
+        }
+        Data += Sent;
+        Size -= Sent;
+      }
+      return true;
+    };
+
+    const double StartTime = FPlatformTime::Seconds();
+    const FTCHARToUTF8 Header(*(Kind + TEXT("\n")));
+    bool bOk = SendAll((const uint8*)Header.Get(), Header.Length());
+    TArray<uint8> Block;
+    Block.SetNumUninitialized((int32)FDumpStream::BlockSize);
+    int64 Total = 0;
+    if (Kind == TEXT("Cues"))
+    {
+      // Send the .cue files listed in Cues.txt inline. Files that can't be read are sent as paths.
+      FDumpText List;
+      bOk = REDump::LoadText(Path, List);
+      for (int32 Idx = 0; bOk && Idx < List.Lines.Num(); ++Idx)
+      {
+        const FAnsiStringView Line = List.Lines[Idx];
+        if (Line.Len() <= 2 || Line.StartsWith(' '))
+        {
+          continue;
+        }
+        const FString CuePath = REDump::ToFString(Line);
+        TArray<uint8> Body;
+        const bool bInline = FFileHelper::LoadFileToArray(Body, *CuePath);
+        const FTCHARToUTF8 Record(*(bInline ? FString::Printf(TEXT("%s\t%d\n"), *CuePath, Body.Num()) : CuePath + TEXT("\n")));
+        bOk = SendAll((const uint8*)Record.Get(), Record.Length()) && SendAll(Body.GetData(), Body.Num());
+        Total += Record.Length() + Body.Num();
+      }
+    }
+    while (bOk && Kind != TEXT("Cues"))
+    {
+      const int64 Count = Stream.Read(Block.GetData(), Block.Num());
+      if (Count <= 0)
+      {
+        bOk = !Count;
+        break;
+      }
+      bOk = SendAll(Block.GetData(), (int32)Count);
+      Total += Count;
+      if (Rate > 0.f)
+      {
+        const double Ahead = StartTime + Total / (Rate * 1024. * 1024.) - FPlatformTime::Seconds();
+        if (Ahead > 0.)
+        {
+          FPlatformProcess::Sleep((float)Ahead);
+        }
+      }
+    }
+    Socket->Shutdown(ESocketShutdownMode::Write);
+    Socket->Close();
+    SocketSubsystem->DestroySocket(Socket);
+    if (bOk)
+    {
+      UE_LOG(LogTemp, Display, TEXT("RE Helper: Replayed %lld bytes of \"%s\" in %.2f s"), Total, *Path, FPlatformTime::Seconds() - StartTime);
+    }
+    else
+    {
+      UE_LOG(LogTemp, Error, TEXT("RE Helper: Replay of \"%s\" failed after %lld bytes. %s"), *Path, Total, *Stream.GetError());
+    }
+  });
+}
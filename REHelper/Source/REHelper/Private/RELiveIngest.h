@@ -0,0 +1,21 @@
+#pragma once
+#include "CoreMinimal.h"
+
+// Receives RE dumps over a loopback TCP connection and imports them while they arrive.
+// A client sends the dump kind on the first line ("Materials", "Cues" or "T3D") followed by the dump itself.
+// The dump ends when the client closes the connection. Connections are served one at a time.
+// A "Cues" dump is made of "<Name>\t<Size>" lines each followed by Size bytes of a .cue file, or of .cue paths.
+class RELiveIngest {
+public:
+  RELiveIngest() = delete;
+  ~RELiveIngest() = delete;
+
+  // Start listening on 127.0.0.1:REHelper.Ingest.Port
+  static bool Start(FString& OutError);
+  // Stop listening and drop the connection in progress
+  static void Stop();
+  static bool IsRunning();
+
+  // Send a dump file to the listener from a background thread. A local stand-in for Real Editor.
+  static void Replay(const FString& Kind, const FString& Path);
+};
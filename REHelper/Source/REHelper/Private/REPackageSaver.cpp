@@ -0,0 +1,234 @@
+#include "REPackageSaver.h"
+#include "REImportCheckpoint.h"
+
+#include "Editor.h"
+#include "FileHelpers.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/PackageName.h"
+#include "Misc/ScopedSlowTask.h"
+#include "UObject/Package.h"
+
+namespace
+{
+  TAutoConsoleVariable<int32> CVarSaveAfterImport(
+    TEXT("REHelper.SaveAfterImport"),
+    0,
+    TEXT("Save packages created or modified by an import when it ends. Modified packages and maps are checked out from source control first."));
+
+  TAutoConsoleVariable<int32> CVarSaveAsync(
+    TEXT("REHelper.SaveAfterImport.Async"),
+    1,
+    TEXT("Write new packages to disk on worker threads while the next package is serialized. 0 to write them one by one."));
+
+  struct FTrackedPackage {
+    TWeakObjectPtr<UPackage> Package;
+    // Didn't exist on disk when it was dirtied
+    bool bCreated = false;
+  };
+
+  int32 SaveDepth = 0;
+  TArray<FTrackedPackage> Tracked;
+  TSet<FName> Seen;
+  FDelegateHandle DirtyHandle;
+  // The scope ended inside a transaction. Saved by SaveDeferred.
+  bool bDeferred = false;
+  FPackageSaveStats ScopeStats;
+  FPackageSaveStats LastStats;
+
+  // Packages that were dirty before the scope don't change state and are left to the user
+  void OnDirtyStateChanged(UPackage* Package)
+  {
+    if (!Package || !Package->IsDirty() || Package == GetTransientPackage() || Package->HasAnyPackageFlags(PKG_CompiledIn))
+    {
+      return;
+    }
+    bool bSeen = false;
+    Seen.Add(Package->GetFName(), &bSeen);
+    if (!bSeen)
+    {
+      Tracked.Add({ Package, !FPackageName::DoesPackageExist(Package->GetName()) });
+    }
+  }
+}
+
+void FPackageSaveStats::Append(const FPackageSaveStats& Other)
+{
+  NumSaved += Other.NumSaved;
+  NumFailed += Other.NumFailed;
+  Bytes += Other.Bytes;
+  Seconds += Other.Seconds;
+}
+
+FString FPackageSaveStats::ToString() const
+{
+  if (!NumSaved && !NumFailed)
+  {
+    return FString();
+  }
+  FString Result = FString::Printf(TEXT("Saved %d packages (%.1f MB) in %.2f s."), NumSaved, Bytes / (1024. * 1024.), Seconds);
+  if (NumFailed)
+  {
+    Result += FString::Printf(TEXT(" Failed to save %d packages."), NumFailed);
+  }
+  return Result;
+}
+
+bool REPackageSaver::IsEnabled()
+{
+  return CVarSaveAfterImport.GetValueOnGameThread() != 0;
+}
+
+FPackageSaveStats REPackageSaver::Save(const TArray<UPackage*>& Packages)
+{
+  FPackageSaveStats Stats;
+  if (!Packages.Num())
+  {
+    return Stats;
+  }
+  const double StartTime = FPlatformTime::Seconds();
+  const bool bAsync = CVarSaveAsync.GetValueOnGameThread() != 0;
+  const uint32 SaveFlags = SAVE_NoError | (bAsync ? SAVE_Async : SAVE_None);
+
+  FScopedSlowTask Task((float)Packages.Num(), FText::Format(NSLOCTEXT("REHelper", "SavingPackages", "Saving {0} packages..."), Packages.Num()));
+  Task.MakeDialog();
+  // Files that exist may be under source control, and worlds need the editor's pre and post save handling
+  TArray<UPackage*> EditorSaves;
+  for (UPackage* Package : Packages)
+  {
+    Task.EnterProgressFrame(1.f);
+    if (Package->ContainsMap() || FPackageName::DoesPackageExist(Package->GetName()))
+    {
+      EditorSaves.Add(Package);
+      continue;
+    }
+    UObject* Asset = Package->FindAssetInPackage();
+    if (!Asset)
+    {
+      UE_LOG(LogTemp, Warning, TEXT("RE Helper: %s has no asset to save"), *Package->GetName());
+      Stats.NumFailed++;
+      continue;
+    }
+    const FString Filename = FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetAssetPackageExtension());
+    const FSavePackageResultStruct Result = UPackage::Save(Package, Asset, RF_Standalone, *Filename, GWarn, nullptr, false, true, SaveFlags, nullptr, FDateTime::MinValue(), false);
+    if (Result.Result == ESavePackageResult::Success)
+    {
+      Stats.NumSaved++;
+      Stats.Bytes += Result.TotalFileSize;
+    }
+    else
+    {
+      UE_LOG(LogTemp, Error, TEXT("RE Helper: Failed to save %s. Check if the file is writable."), *Filename);
+      Stats.NumFailed++;
+    }
+  }
+  if (bAsync)
+  {
+    UPackage::WaitForAsyncFileWrites();
+  }
+
+  if (EditorSaves.Num())
+  {
+    // Checks the files out and saves them without asking
+    TArray<UPackage*> Failed;
+    FEditorFileUtils::PromptForCheckoutAndSave(EditorSaves, true, false, &Failed);
+    for (UPackage* Package : EditorSaves)
+    {
+      if (Failed.Contains(Package) || Package->IsDirty())
+      {
+        Stats.NumFailed++;
+        continue;
+      }
+      const FString& Extension = Package->ContainsMap() ? FPackageName::GetMapPackageExtension() : FPackageName::GetAssetPackageExtension();
+      Stats.NumSaved++;
+      Stats.Bytes += FMath::Max<int64>(IFileManager::Get().FileSize(*FPackageName::LongPackageNameToFilename(Package->GetName(), Extension)), 0);
+    }
+  }
+
+  Stats.Seconds = FPlatformTime::Seconds() - StartTime;
+  UE_LOG(LogTemp, Display, TEXT("RE Helper: %s %.1f MB/s"), *Stats.ToString(), Stats.Seconds > 0. ? Stats.Bytes / (1024. * 1024.) / Stats.Seconds : 0.);
+  if (SaveDepth)
+  {
+    ScopeStats.Append(Stats);
+  }
+  return Stats;
+}
+
+FString REPackageSaver::GetLastReport()
+{
+  return LastStats.ToString();
+}
+
+void REPackageSaver::Begin()
+{
+  if (SaveDepth++)
+  {
+    return;
+  }
+  if (!bDeferred)
+  {
+    ScopeStats = FPackageSaveStats();
+  }
+  DirtyHandle = UPackage::PackageDirtyStateChangedEvent.AddStatic(&OnDirtyStateChanged);
+}
+
+void REPackageSaver::End()
+{
+  if (--SaveDepth)
+  {
+    return;
+  }
+  UPackage::PackageDirtyStateChangedEvent.Remove(DirtyHandle);
+  DirtyHandle.Reset();
+  // Saving while a transaction records would leave undo out of sync with the files
+  if (IsEnabled() && GEditor && GEditor->IsTransactionActive())
+  {
+    bDeferred = true;
+    LastStats = ScopeStats;
+    return;
+  }
+  SaveTracked();
+}
+
+void REPackageSaver::SaveDeferred()
+{
+  if (bDeferred && !SaveDepth)
+  {
+    SaveTracked();
+  }
+}
+
+void REPackageSaver::SaveTracked()
+{
+  bDeferred = false;
+  if (IsEnabled())
+  {
+    // Reverting a fast import reloads modified packages from disk
+    const bool bKeepModified = REImportCheckpoint::IsFastImport();
+    int32 NumKept = 0;
+    TArray<UPackage*> Packages;
+    for (const FTrackedPackage& Entry : Tracked)
+    {
+      UPackage* Package = Entry.Package.Get();
+      // Unsaved maps live in /Temp/
+      if (!Package || !Package->IsDirty() || !FPackageName::IsValidLongPackageName(Package->GetName()) || FPackageName::IsTempPackage(Package->GetName()))
+      {
+        continue;
+      }
+      if (!Entry.bCreated && bKeepModified)
+      {
+        NumKept++;
+        continue;
+      }
+      Packages.Add(Package);
+    }
+    ScopeStats.Append(Save(Packages));
+    if (NumKept)
+    {
+      UE_LOG(LogTemp, Display, TEXT("RE Helper: Left %d modified packages unsaved so REHelper.RevertImport can restore them"), NumKept);
+    }
+  }
+  LastStats = ScopeStats;
+  Tracked.Empty();
+  Seen.Empty();
+}
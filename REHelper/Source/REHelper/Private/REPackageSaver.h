@@ -0,0 +1,60 @@
+#pragma once
+#include "CoreMinimal.h"
+
+struct FPackageSaveStats {
+  int32 NumSaved = 0;
+  int32 NumFailed = 0;
+  int64 Bytes = 0;
+  double Seconds = 0.;
+
+  void Append(const FPackageSaveStats& Other);
+  // "Saved N packages (X MB) in Y s." Empty if nothing was saved.
+  FString ToString() const;
+};
+
+// Saves what imports create and modify if REHelper.SaveAfterImport is set, so nobody has to wait through "Save All" afterwards.
+// New packages are serialized on the game thread one after another while their files are written by async tasks,
+// so disk writes overlap the serialization of the next package. Existing files and maps go through the editor's
+// save with a source control checkout.
+class REPackageSaver {
+public:
+  REPackageSaver() = delete;
+  ~REPackageSaver() = delete;
+
+  // REHelper.SaveAfterImport
+  static bool IsEnabled();
+
+  // Save packages as one batch and wait for their files
+  static FPackageSaveStats Save(const TArray<UPackage*>& Packages);
+
+  // Save what a scope that ended inside a transaction held back. FScopedImportTransaction calls it after the transaction is closed.
+  static void SaveDeferred();
+
+  // Everything the latest outermost scope saved, including batched import saves. Empty if nothing was saved.
+  static FString GetLastReport();
+
+private:
+  friend struct FScopedPackageSave;
+
+  static void Begin();
+  static void End();
+  static void SaveTracked();
+};
+
+// Tracks packages dirtied during its lifetime and saves them when the outermost scope ends,
+// or once the enclosing FScopedImportTransaction is closed.
+// During a fast import only created packages are saved, so REHelper.RevertImport can still reload the modified ones.
+struct FScopedPackageSave {
+  FScopedPackageSave()
+  {
+    REPackageSaver::Begin();
+  }
+
+  ~FScopedPackageSave()
+  {
+    REPackageSaver::End();
+  }
+
+  FScopedPackageSave(const FScopedPackageSave&) = delete;
+  FScopedPackageSave& operator=(const FScopedPackageSave&) = delete;
+};
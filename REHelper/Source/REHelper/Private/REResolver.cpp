@@ -0,0 +1,430 @@
+#include "REResolver.h"
+#include "REAssetIndex.h"
+
+#include "AssetRegistryModule.h"
+#include "Engine/StreamableManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/PackageName.h"
+#include "Misc/ScopedSlowTask.h"
+
+namespace
+{
+  TAutoConsoleVariable<int32> CVarResolverCache(
+    TEXT("REHelper.ResolverCache"),
+    1,
+    TEXT("Cache asset lookups during an import, including missing assets."));
+
+  TAutoConsoleVariable<int32> CVarResolverIndex(
+    TEXT("REHelper.ResolverIndex"),
+    1,
+    TEXT("Check asset existence with the asset registry before loading packages."));
+
+  TAutoConsoleVariable<int32> CVarPersistentIndex(
+    TEXT("REHelper.PersistentIndex"),
+    1,
+    TEXT("Keep directory asset lists in Saved/REHelper and reuse them while the directory is unchanged."));
+
+  TAutoConsoleVariable<int32> CVarResolverPreload(
+    TEXT("REHelper.ResolverPreload"),
+    1,
+    TEXT("Load assets referenced by a dump in one async batch before the import creates anything."));
+
+  struct FCachedObject {
+    UClass* Class = nullptr;
+    // Null for assets that were not found
+    TWeakObjectPtr<UObject> Object;
+    bool bFound = false;
+  };
+
+  // Most paths are requested with a single class
+  using FCachedObjects = TArray<FCachedObject, TInlineAllocator<1>>;
+
+  // Normalized path to lookup results. Keys are case-insensitive.
+  TMap<FString, FCachedObjects> Cache;
+  int32 CacheDepth = 0;
+  int32 Hits = 0;
+  int32 Misses = 0;
+  int32 IndexMisses = 0;
+  int32 StoredDirs = 0;
+  int32 ScannedDirs = 0;
+
+  enum class EAssetState : uint8 {
+    // Not indexed or the class isn't loaded
+    Unknown,
+    Missing,
+    Exists
+  };
+
+  // Object path to the asset class of every asset in IndexedDirs. Null class if it isn't loaded.
+  TMap<FName, UClass*> AssetIndex;
+  TSet<FString> IndexedDirs;
+  // Short class names of the persistent index
+  TMap<FName, UClass*> ClassesByName;
+
+  // Created on first use. FStreamableManager can't be constructed before UObjects are initialized.
+  TUniquePtr<FStreamableManager> Streamable;
+  // Keep preloaded assets from being collected during the import
+  TArray<TSharedPtr<FStreamableHandle>> PreloadHandles;
+
+  // "/Game/A/B" to "/Game/A/B.B"
+  FString ToObjectPath(const FString& NormalizedPath)
+  {
+    int32 Dot = INDEX_NONE;
+    if (NormalizedPath.FindLastChar('.', Dot) && Dot > NormalizedPath.Find(TEXT("/"), ESearchCase::CaseSensitive, ESearchDir::FromEnd))
+    {
+      return NormalizedPath;
+    }
+    return NormalizedPath + TEXT(".") + FPackageName::GetShortName(NormalizedPath);
+  }
+
+  FString GetDirectory(const FString& ObjectPath)
+  {
+    return FPackageName::GetLongPackagePath(FPackageName::ObjectPathToPackageName(ObjectPath));
+  }
+
+  void IndexDirectories(const TArray<FString>& Dirs)
+  {
+    TArray<FString> NewDirs;
+    for (const FString& Dir : Dirs)
+    {
+      if (!IndexedDirs.Contains(Dir))
+      {
+        IndexedDirs.Add(Dir);
+        NewDirs.Add(Dir);
+      }
+    }
+    if (!NewDirs.Num())
+    {
+      return;
+    }
+
+    TArray<FString> StaleDirs;
+    const bool bPersistent = CVarPersistentIndex.GetValueOnGameThread() != 0;
+    for (const FString& Dir : NewDirs)
+    {
+      TArray<FIndexedAsset> Stored;
+      if (!bPersistent || !REAssetIndex::Find(Dir, Stored))
+      {
+        StaleDirs.Add(Dir);
+        continue;
+      }
+      StoredDirs++;
+      for (const FIndexedAsset& Asset : Stored)
+      {
+        UClass*& Class = ClassesByName.FindOrAdd(Asset.Class);
+        if (!Class)
+        {
+          Class = FindObject<UClass>(ANY_PACKAGE, *Asset.Class.ToString());
+        }
+        AssetIndex.Add(Asset.ObjectPath, Class);
+      }
+    }
+    if (!StaleDirs.Num())
+    {
+      return;
+    }
+
+    ScannedDirs += StaleDirs.Num();
+    IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+    // Cheap for paths the editor has already discovered
+    AssetRegistry.ScanPathsSynchronous(StaleDirs, false);
+    FARFilter Filter;
+    for (const FString& Dir : StaleDirs)
+    {
+      Filter.PackagePaths.Add(*Dir);
+    }
+    TArray<FAssetData> Assets;
+    AssetRegistry.GetAssets(Filter, Assets);
+    AssetIndex.Reserve(AssetIndex.Num() + Assets.Num());
+    TMap<FName, TArray<FIndexedAsset>> ByDir;
+    for (const FAssetData& Asset : Assets)
+    {
+      AssetIndex.Add(Asset.ObjectPath, Asset.GetClass());
+      ByDir.FindOrAdd(Asset.PackagePath).Add({ Asset.ObjectPath, Asset.AssetClass });
+    }
+    if (bPersistent)
+    {
+      for (const FString& Dir : StaleDirs)
+      {
+        REAssetIndex::Update(Dir, ByDir.FindRef(*Dir));
+      }
+    }
+  }
+
+  EAssetState GetAssetState(const FString& NormalizedPath, UClass* Class)
+  {
+    if (!CacheDepth || !CVarResolverIndex.GetValueOnGameThread())
+    {
+      return EAssetState::Unknown;
+    }
+    const FString ObjectPath = ToObjectPath(NormalizedPath);
+    const FString Dir = GetDirectory(ObjectPath);
+    if (!IndexedDirs.Contains(Dir))
+    {
+      IndexDirectories({ Dir });
+    }
+    // Indexed paths are FNames already. A path that isn't one can't be in the index.
+    const FName Key(*ObjectPath, FNAME_Find);
+    UClass** AssetClass = Key.IsNone() ? nullptr : AssetIndex.Find(Key);
+    if (!AssetClass)
+    {
+      // New packages that are not saved yet can't be in the stored index
+      return FindPackage(nullptr, *FPackageName::ObjectPathToPackageName(ObjectPath)) ? EAssetState::Unknown : EAssetState::Missing;
+    }
+    if (!*AssetClass)
+    {
+      return EAssetState::Unknown;
+    }
+    return (*AssetClass)->IsChildOf(Class) ? EAssetState::Exists : EAssetState::Missing;
+  }
+}
+
+REResolver::EIndexState REResolver::GetIndexState(const FString& Path, UClass* Class)
+{
+  const FString ObjectPath = ToObjectPath(NormalizePath(Path));
+  if (!IndexedDirs.Contains(GetDirectory(ObjectPath)))
+  {
+    return EIndexState::Unknown;
+  }
+  const FName Key(*ObjectPath, FNAME_Find);
+  UClass* const* AssetClass = Key.IsNone() ? nullptr : AssetIndex.Find(Key);
+  if (!AssetClass)
+  {
+    return EIndexState::Missing;
+  }
+  if (!*AssetClass)
+  {
+    return EIndexState::Unknown;
+  }
+  return (*AssetClass)->IsChildOf(Class) ? EIndexState::Exists : EIndexState::WrongClass;
+}
+
+REResolver::EIndexState REResolver::GetLoadedState(const FString& Path, UClass* Class)
+{
+  check(IsInGameThread());
+  UObject* Object = FindObject<UObject>(nullptr, *ToObjectPath(NormalizePath(Path)));
+  if (!Object || Object->IsPendingKill())
+  {
+    return EIndexState::Missing;
+  }
+  return Object->IsA(Class) ? EIndexState::Exists : EIndexState::WrongClass;
+}
+
+UObject* REResolver::Find(const FString& Path, UClass* Class)
+{
+  const FString Normalized = NormalizePath(Path);
+  if (!CacheDepth || !CVarResolverCache.GetValueOnGameThread())
+  {
+    if (GetAssetState(Normalized, Class) == EAssetState::Missing)
+    {
+      return nullptr;
+    }
+    // FindObject for some reasons doesn't like untyped search. Use LoadObject() instead.
+    return StaticLoadObject(Class, nullptr, *Normalized);
+  }
+
+  FCachedObjects& Entries = Cache.FindOrAdd(Normalized);
+  for (FCachedObject& Entry : Entries)
+  {
+    if (Entry.Class != Class)
+    {
+      continue;
+    }
+    if (!Entry.bFound)
+    {
+      Hits++;
+      return nullptr;
+    }
+    if (UObject* Object = Entry.Object.Get())
+    {
+      Hits++;
+      return Object;
+    }
+    // Collected since it was cached
+    Misses++;
+    UObject* Object = StaticLoadObject(Class, nullptr, *Normalized);
+    Entry.Object = Object;
+    Entry.bFound = Object != nullptr;
+    return Object;
+  }
+
+  UObject* Object = nullptr;
+  if (GetAssetState(Normalized, Class) == EAssetState::Missing)
+  {
+    IndexMisses++;
+  }
+  else
+  {
+    Misses++;
+    Object = StaticLoadObject(Class, nullptr, *Normalized);
+  }
+  FCachedObject& Entry = Entries.AddDefaulted_GetRef();
+  Entry.Class = Class;
+  Entry.Object = Object;
+  Entry.bFound = Object != nullptr;
+  return Object;
+}
+
+bool REResolver::Exists(const FString& Path, UClass* Class)
+{
+  const FString Normalized = NormalizePath(Path);
+  switch (GetAssetState(Normalized, Class))
+  {
+  case EAssetState::Exists:
+    return true;
+  case EAssetState::Missing:
+    return false;
+  default:
+    return Find(Normalized, Class) != nullptr;
+  }
+}
+
+void REResolver::PreIndex(const TArray<FString>& Paths)
+{
+  if (!CacheDepth || !CVarResolverIndex.GetValueOnGameThread())
+  {
+    return;
+  }
+  TSet<FString> Dirs;
+  for (const FString& Path : Paths)
+  {
+    if (Path.Len() && Path != TEXT("None"))
+    {
+      Dirs.Add(GetDirectory(ToObjectPath(NormalizePath(Path))));
+    }
+  }
+  IndexDirectories(Dirs.Array());
+}
+
+void REResolver::Preload(const TArray<FString>& Paths)
+{
+  if (!CacheDepth)
+  {
+    return;
+  }
+  PreIndex(Paths);
+  if (!CVarResolverPreload.GetValueOnGameThread())
+  {
+    return;
+  }
+
+  TSet<FString> Unique;
+  TArray<FSoftObjectPath> Targets;
+  for (const FString& Path : Paths)
+  {
+    if (!Path.Len() || Path == TEXT("None"))
+    {
+      continue;
+    }
+    const FString Normalized = NormalizePath(Path);
+    bool bDuplicate = false;
+    Unique.Add(Normalized, &bDuplicate);
+    // Missing assets would only produce async loading errors
+    if (bDuplicate || GetAssetState(Normalized, UObject::StaticClass()) == EAssetState::Missing)
+    {
+      continue;
+    }
+    FSoftObjectPath Target(ToObjectPath(Normalized));
+    if (!Target.ResolveObject())
+    {
+      Targets.Add(MoveTemp(Target));
+    }
+  }
+  if (!Targets.Num())
+  {
+    return;
+  }
+
+  const double StartTime = FPlatformTime::Seconds();
+  if (!Streamable)
+  {
+    Streamable = MakeUnique<FStreamableManager>();
+  }
+  TSharedPtr<FStreamableHandle> Handle = Streamable->RequestAsyncLoad(Targets, FStreamableDelegate(), FStreamableManager::AsyncLoadHighPriority);
+  if (!Handle)
+  {
+    return;
+  }
+  FScopedSlowTask Task((float)Targets.Num(), FText::Format(NSLOCTEXT("REHelper", "Preloading", "Loading {0} referenced assets..."), Targets.Num()));
+  float Reported = 0.f;
+  while (!Handle->HasLoadCompleted() && !Handle->WasCanceled())
+  {
+    Handle->WaitUntilComplete(.1f);
+    const float Loaded = Handle->GetProgress() * Targets.Num();
+    Task.EnterProgressFrame(Loaded - Reported);
+    Reported = Loaded;
+  }
+  PreloadHandles.Add(Handle);
+  UE_LOG(LogTemp, Display, TEXT("RE Helper: Preloaded %d assets in %.2f s"), Targets.Num(), FPlatformTime::Seconds() - StartTime);
+}
+
+FString REResolver::NormalizePath(FString Path)
+{
+  Path.RemoveFromStart(TEXT("/"));
+  Path.RemoveFromStart(TEXT("Content/"));
+  Path.StartsWith(TEXT("Game/")) == true ? Path.InsertAt(0, TEXT("/")) : Path.InsertAt(0, TEXT("/Game/"));
+  return Path;
+}
+
+void REResolver::OnAssetCreated(UObject* Asset)
+{
+  REAssetIndex::Invalidate(FPackageName::GetLongPackagePath(Asset->GetOutermost()->GetName()));
+  if (!CacheDepth)
+  {
+    return;
+  }
+  // A failed lookup of this path may be cached
+  Cache.Remove(Asset->GetOutermost()->GetName());
+  Cache.Remove(Asset->GetPathName());
+  AssetIndex.Add(*Asset->GetPathName(), Asset->GetClass());
+}
+
+int32 REResolver::GetHits()
+{
+  return Hits + IndexMisses;
+}
+
+int32 REResolver::GetMisses()
+{
+  return Misses;
+}
+
+void REResolver::BeginCache()
+{
+  if (!CacheDepth++)
+  {
+    Hits = 0;
+    Misses = 0;
+    IndexMisses = 0;
+    StoredDirs = 0;
+    ScannedDirs = 0;
+  }
+}
+
+void REResolver::EndCache()
+{
+  check(CacheDepth > 0);
+  if (--CacheDepth)
+  {
+    return;
+  }
+  const int32 Total = Hits + IndexMisses + Misses;
+  if (Total)
+  {
+    UE_LOG(LogTemp, Display, TEXT("RE Helper: Resolved %d asset paths: %d cache hits, %d missing per asset registry, %d loads (%.1f%% without a load)"), Total, Hits, IndexMisses, Misses, (Hits + IndexMisses) * 100. / Total);
+  }
+  if (StoredDirs || ScannedDirs)
+  {
+    UE_LOG(LogTemp, Display, TEXT("RE Helper: Indexed %d directories, %d from \"%s\""), StoredDirs + ScannedDirs, StoredDirs, *REAssetIndex::GetIndexPath());
+  }
+  REAssetIndex::Flush();
+  Cache.Empty();
+  AssetIndex.Empty();
+  IndexedDirs.Empty();
+  ClassesByName.Empty();
+  for (const TSharedPtr<FStreamableHandle>& Handle : PreloadHandles)
+  {
+    Handle->ReleaseHandle();
+  }
+  PreloadHandles.Empty();
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtr.h"
+
+// Resolves asset paths from RE dumps to objects.
+// While an FScopedResolverCache is alive results are cached by path and class, including failed lookups.
+// Existence is answered by an asset registry index of the directories involved, so missing assets are never searched for on disk.
+class REResolver {
+public:
+  REResolver() = delete;
+  ~REResolver() = delete;
+
+  // Load an object by a dump path like "Textures/Foo" or "/Game/Textures/Foo"
+  static UObject* Find(const FString& Path, UClass* Class);
+
+  template <typename T>
+  static T* Find(const FString& Path)
+  {
+    return Cast<T>(Find(Path, T::StaticClass()));
+  }
+
+  // Check if an asset exists without loading it. Falls back to a load if the registry can't tell.
+  static bool Exists(const FString& Path, UClass* Class);
+
+  template <typename T>
+  static bool Exists(const FString& Path)
+  {
+    return Exists(Path, T::StaticClass());
+  }
+
+  enum class EIndexState : uint8 {
+    // The directory isn't indexed or the asset class isn't loaded
+    Unknown,
+    Missing,
+    WrongClass,
+    Exists
+  };
+
+  // Look a path up in the directories indexed so far. Doesn't index or load anything, so worker threads
+  // may call it while the game thread waits for them.
+  static EIndexState GetIndexState(const FString& Path, UClass* Class);
+  // Look a path up among loaded objects, e.g. assets created but not saved yet. Game thread only.
+  static EIndexState GetLoadedState(const FString& Path, UClass* Class);
+
+  // Index the directories of dump paths with a single registry scan. Directories are also indexed on first use.
+  static void PreIndex(const TArray<FString>& Paths);
+  // Load the existing assets of dump paths together through the async loader and wait for them.
+  // They stay loaded until the outermost scope ends. Indexes their directories too.
+  static void Preload(const TArray<FString>& Paths);
+
+  // Dump path to a /Game/ path
+  static FString NormalizePath(FString Path);
+  // Drop cached results for the asset's path and add it to the index. Call it for every created asset.
+  static void OnAssetCreated(UObject* Asset);
+
+  // Lookups served from the cache and lookups that went to LoadObject since the outermost scope began
+  static int32 GetHits();
+  static int32 GetMisses();
+
+private:
+  friend struct FScopedResolverCache;
+
+  static void BeginCache();
+  static void EndCache();
+};
+
+// Caches REResolver lookups for its lifetime and logs the counters. Scopes can be nested.
+struct FScopedResolverCache {
+  FScopedResolverCache()
+  {
+    REResolver::BeginCache();
+  }
+
+  ~FScopedResolverCache()
+  {
+    REResolver::EndCache();
+  }
+
+  FScopedResolverCache(const FScopedResolverCache&) = delete;
+  FScopedResolverCache& operator=(const FScopedResolverCache&) = delete;
+};
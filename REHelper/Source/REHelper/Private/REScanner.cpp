@@ -0,0 +1,42 @@
+#include "REScanner.h"
+#include "Core/REDumpCore.h"
+
+const ANSICHAR* REScanner::FindChar(const ANSICHAR* Begin, const ANSICHAR* End, ANSICHAR Ch)
+{
+  return REDumpCore::FindChar(Begin, End, Ch);
+}
+
+const ANSICHAR* REScanner::FindEntryStart(const ANSICHAR* Begin, const ANSICHAR* End)
+{
+  return REDumpCore::FindEntryStart(Begin, End);
+}
+
+const ANSICHAR* REScanner::FindLastEntryStart(const ANSICHAR* Begin, const ANSICHAR* End)
+{
+  return REDumpCore::FindLastEntryStart(Begin, End);
+}
+
+void REScanner::SplitLines(const ANSICHAR* Begin, const ANSICHAR* End, TArray<FAnsiStringView>& OutLines, bool bCullEmpty)
+{
+  REDumpCore::ForEachLine(Begin, End, bCullEmpty, [&OutLines](const ANSICHAR* Line, size_t Len) {
+    OutLines.Emplace(Line, (int32)Len);
+  });
+}
+
+const TCHAR* REScanner::GetInstructionSet()
+{
+  switch (REDumpCore::GetInstructionSet())
+  {
+  case REDumpCore::EInstructionSet::AVX2:
+    return TEXT("AVX2");
+  case REDumpCore::EInstructionSet::SSE2:
+    return TEXT("SSE2");
+  default:
+    return TEXT("Scalar");
+  }
+}
+
+void REScanner::SetForceScalar(bool bForce)
+{
+  REDumpCore::SetForceScalar(bForce);
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Containers/StringView.h"
+
+// Byte scanner shared by all RE dump readers. UE facing wrapper of the REDumpCore scanner.
+class REScanner {
+public:
+  REScanner() = delete;
+  ~REScanner() = delete;
+
+  // First Ch in [Begin, End). Returns End if there is none.
+  static const ANSICHAR* FindChar(const ANSICHAR* Begin, const ANSICHAR* End, ANSICHAR Ch);
+  // Start of the first line after Begin that doesn't begin with a space, i.e. the next top level dump entry. Returns End if there is none.
+  static const ANSICHAR* FindEntryStart(const ANSICHAR* Begin, const ANSICHAR* End);
+  // Start of the last line in (Begin, End) that doesn't begin with a space. Returns Begin if there is none.
+  static const ANSICHAR* FindLastEntryStart(const ANSICHAR* Begin, const ANSICHAR* End);
+  // Split text to lines without line terminators
+  static void SplitLines(const ANSICHAR* Begin, const ANSICHAR* End, TArray<FAnsiStringView>& OutLines, bool bCullEmpty = true);
+
+  // Name of the instruction set in use
+  static const TCHAR* GetInstructionSet();
+  // Disable vector code. Used to benchmark the scalar fallback.
+  static void SetForceScalar(bool bForce);
+};
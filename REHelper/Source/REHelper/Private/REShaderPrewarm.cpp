@@ -0,0 +1,353 @@
+#include "REShaderPrewarm.h"
+#include "REResolver.h"
+
+#include "Containers/Ticker.h"
+#include "Framework/Application/SlateApplication.h"
+#include "Framework/Notifications/NotificationManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Interfaces/IProjectManager.h"
+#include "Interfaces/ITargetPlatform.h"
+#include "Interfaces/ITargetPlatformManagerModule.h"
+#include "Materials/MaterialInterface.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+#include "ProjectDescriptor.h"
+#include "ShaderCompiler.h"
+#include "Widgets/Notifications/SNotificationList.h"
+
+namespace
+{
+  TAutoConsoleVariable<int32> CVarPrewarm(
+    TEXT("REHelper.Prewarm"),
+    0,
+    TEXT("Compile shaders of imported materials for the target platforms in the background after a material import."));
+
+  TAutoConsoleVariable<FString> CVarPrewarmPlatforms(
+    TEXT("REHelper.Prewarm.Platforms"),
+    TEXT(""),
+    TEXT("Comma separated target platforms to prewarm, e.g. \"WindowsNoEditor,LinuxNoEditor\". Empty for -TargetPlatform= or the project's target platforms (the host's game platform if it lists none)."));
+
+  TAutoConsoleVariable<int32> CVarPrewarmMaxInFlight(
+    TEXT("REHelper.Prewarm.MaxInFlight"),
+    32,
+    TEXT("Materials compiled at once. Each one holds its platform shader maps in memory until it's done."));
+
+  // Materials of the latest import
+  TArray<FSoftObjectPath> LastImport;
+  // Materials before QueueHead are taken already. Popping from the head keeps the import order without shifting the array.
+  TArray<FSoftObjectPath> Queue;
+  int32 QueueHead = 0;
+  TArray<TWeakObjectPtr<UMaterialInterface>> InFlight;
+  TArray<const ITargetPlatform*> Platforms;
+  int32 NumTotal = 0;
+  int32 NumDone = 0;
+  double StartTime = 0.;
+  bool bCancelled = false;
+  FDelegateHandle TickerHandle;
+  TSharedPtr<SNotificationItem> Notification;
+
+  TArray<const ITargetPlatform*> GetPlatforms()
+  {
+    ITargetPlatformManagerModule* Manager = GetTargetPlatformManager();
+    if (!Manager)
+    {
+      return {};
+    }
+    const FString Names = CVarPrewarmPlatforms.GetValueOnGameThread();
+    TArray<FString> Items;
+    FString CommandLinePlatforms;
+    if (!Names.IsEmpty())
+    {
+      Names.ParseIntoArray(Items, TEXT(","));
+    }
+    else if (FParse::Value(FCommandLine::Get(), TEXT("TargetPlatform="), CommandLinePlatforms))
+    {
+      CommandLinePlatforms.ParseIntoArray(Items, TEXT("+"));
+    }
+    else
+    {
+      // Without any, the active platform is the editor itself, whose shaders the import has just compiled
+      const FProjectDescriptor* Project = IProjectManager::Get().GetCurrentProject();
+      if (Project)
+      {
+        for (const FName& Platform : Project->TargetPlatforms)
+        {
+          Items.Add(Platform.ToString());
+        }
+      }
+      if (!Items.Num())
+      {
+        Items.Add(FString(FPlatformProperties::IniPlatformName()) + TEXT("NoEditor"));
+      }
+    }
+    TArray<const ITargetPlatform*> Result;
+    for (const FString& Item : Items)
+    {
+      if (const ITargetPlatform* Platform = Manager->FindTargetPlatform(Item.TrimStartAndEnd()))
+      {
+        Result.Add(Platform);
+      }
+      else
+      {
+        UE_LOG(LogTemp, Warning, TEXT("RE Helper: Unknown target platform \"%s\". Skipping it."), *Item);
+      }
+    }
+    // The editor's own shaders are compiled by the import already
+    const int32 NumFound = Result.Num();
+    Result.RemoveAll([](const ITargetPlatform* Platform) { return Platform->IsRunningPlatform(); });
+    if (NumFound && !Result.Num())
+    {
+      UE_LOG(LogTemp, Warning, TEXT("RE Helper: The only prewarm platform is the running editor, whose shaders are compiled by the import. Set REHelper.Prewarm.Platforms to a game platform."));
+    }
+    return Result;
+  }
+
+  bool IsCached(UMaterialInterface* Material)
+  {
+    for (const ITargetPlatform* Platform : Platforms)
+    {
+      if (!Material->IsCachedCookedPlatformDataLoaded(Platform))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  int32 GetNumQueued()
+  {
+    return Queue.Num() - QueueHead;
+  }
+
+  void ClearQueue()
+  {
+    Queue.Empty();
+    QueueHead = 0;
+  }
+
+  FText GetProgressText()
+  {
+    if (bCancelled)
+    {
+      return FText::FromString(FString::Printf(TEXT("Cancelling shader prewarm: %d materials left"), InFlight.Num()));
+    }
+    return FText::FromString(FString::Printf(TEXT("Prewarming shaders: %d of %d materials"), NumDone, NumTotal));
+  }
+
+  void Finish()
+  {
+    FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+    TickerHandle.Reset();
+    const FString Message = FString::Printf(TEXT("%s %d of %d materials in %.1f s"), bCancelled ? TEXT("Cancelled shader prewarm after") : TEXT("Prewarmed shaders of"), NumDone, NumTotal, FPlatformTime::Seconds() - StartTime);
+    UE_LOG(LogTemp, Display, TEXT("RE Helper: %s"), *Message);
+    if (Notification)
+    {
+      Notification->SetText(FText::FromString(Message));
+      Notification->SetCompletionState(bCancelled ? SNotificationItem::CS_None : SNotificationItem::CS_Success);
+      Notification->ExpireAndFadeout();
+      Notification.Reset();
+    }
+    ClearQueue();
+    Platforms.Empty();
+    NumTotal = 0;
+    NumDone = 0;
+    bCancelled = false;
+  }
+
+  // Returns false once everything is done
+  bool Update()
+  {
+    for (int32 Idx = InFlight.Num() - 1; Idx >= 0; --Idx)
+    {
+      UMaterialInterface* Material = InFlight[Idx].Get();
+      if (!Material || IsCached(Material))
+      {
+        if (Material)
+        {
+          // The shader maps are in the DDC now. Don't keep them in memory.
+          Material->ClearAllCachedCookedPlatformData();
+        }
+        InFlight.RemoveAtSwap(Idx);
+        NumDone++;
+      }
+    }
+
+    const int32 MaxInFlight = FMath::Max(1, CVarPrewarmMaxInFlight.GetValueOnGameThread());
+    while (!bCancelled && GetNumQueued() && InFlight.Num() < MaxInFlight)
+    {
+      if (UMaterialInterface* Material = Cast<UMaterialInterface>(Queue[QueueHead++].TryLoad()))
+      {
+        for (const ITargetPlatform* Platform : Platforms)
+        {
+          Material->BeginCacheForCookedPlatformData(Platform);
+        }
+        InFlight.Add(Material);
+      }
+      else
+      {
+        NumDone++;
+      }
+    }
+
+    if (!GetNumQueued())
+    {
+      ClearQueue();
+    }
+
+    if (Notification)
+    {
+      Notification->SetText(GetProgressText());
+    }
+    return InFlight.Num() || (!bCancelled && GetNumQueued());
+  }
+
+  bool Tick(float)
+  {
+    if (!Update())
+    {
+      Finish();
+      return false;
+    }
+    return true;
+  }
+
+  // Without an editor loop nobody ticks the ticker or the shader compiling manager
+  void Wait()
+  {
+    double LastReport = FPlatformTime::Seconds();
+    while (Update())
+    {
+      if (GShaderCompilingManager)
+      {
+        GShaderCompilingManager->ProcessAsyncResults(true, false);
+      }
+      if (FPlatformTime::Seconds() - LastReport > 10.)
+      {
+        UE_LOG(LogTemp, Display, TEXT("RE Helper: %s"), *GetProgressText().ToString());
+        LastReport = FPlatformTime::Seconds();
+      }
+      FPlatformProcess::Sleep(0.05f);
+    }
+    Finish();
+  }
+
+  void StartCommand(const TArray<FString>& Args)
+  {
+    TArray<FSoftObjectPath> Materials;
+    if (!Args.Num())
+    {
+      Materials = LastImport;
+    }
+    for (const FString& Arg : Args)
+    {
+      if (UMaterialInterface* Material = REResolver::Find<UMaterialInterface>(Arg))
+      {
+        Materials.Add(Material);
+      }
+      else
+      {
+        UE_LOG(LogTemp, Warning, TEXT("RE Helper: Failed to find material \"%s\""), *Arg);
+      }
+    }
+    if (!Materials.Num())
+    {
+      UE_LOG(LogTemp, Warning, TEXT("RE Helper: Nothing to prewarm. Usage: REHelper.Prewarm.Start [<Material path>...]. Without paths the materials of the latest import are used."));
+      return;
+    }
+    REShaderPrewarm::Start(Materials);
+  }
+
+  FAutoConsoleCommand StartPrewarmCommand(
+    TEXT("REHelper.Prewarm.Start"),
+    TEXT("Compile shaders of materials for the target platforms in the background. Usage: REHelper.Prewarm.Start [<Material path>...]"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&StartCommand));
+
+  FAutoConsoleCommand CancelPrewarmCommand(
+    TEXT("REHelper.Prewarm.Cancel"),
+    TEXT("Stop the shader prewarm"),
+    FConsoleCommandDelegate::CreateStatic(&REShaderPrewarm::Cancel));
+}
+
+void REShaderPrewarm::OnMaterialsImported(const TArray<FSoftObjectPath>& Materials)
+{
+  LastImport = Materials;
+  if (Materials.Num() && CVarPrewarm.GetValueOnGameThread())
+  {
+    Start(Materials);
+  }
+}
+
+void REShaderPrewarm::Start(const TArray<FSoftObjectPath>& Materials)
+{
+  if (!IsRunning())
+  {
+    Platforms = GetPlatforms();
+    if (!Platforms.Num())
+    {
+      UE_LOG(LogTemp, Warning, TEXT("RE Helper: No target platforms to prewarm shaders for"));
+      return;
+    }
+    StartTime = FPlatformTime::Seconds();
+    FString Names;
+    for (const ITargetPlatform* Platform : Platforms)
+    {
+      Names += (Names.Len() ? TEXT(", ") : TEXT("")) + Platform->PlatformName();
+    }
+    UE_LOG(LogTemp, Display, TEXT("RE Helper: Prewarming shaders of %d materials for %s"), Materials.Num(), *Names);
+  }
+  Queue.Append(Materials);
+  NumTotal += Materials.Num();
+
+  if (IsRunningCommandlet() || !FSlateApplication::IsInitialized())
+  {
+    Wait();
+    return;
+  }
+  if (!TickerHandle.IsValid())
+  {
+    TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&Tick), 0.1f);
+  }
+  if (!Notification)
+  {
+    FNotificationInfo Info(GetProgressText());
+    Info.bFireAndForget = false;
+    Info.ButtonDetails.Add(FNotificationButtonInfo(FText::FromString(TEXT("Cancel")), FText::FromString(TEXT("Stop compiling shaders of the remaining materials")), FSimpleDelegate::CreateStatic(&REShaderPrewarm::Cancel), SNotificationItem::CS_Pending));
+    Notification = FSlateNotificationManager::Get().AddNotification(Info);
+    if (Notification)
+    {
+      Notification->SetCompletionState(SNotificationItem::CS_Pending);
+    }
+  }
+}
+
+void REShaderPrewarm::Cancel()
+{
+  if (IsRunning())
+  {
+    bCancelled = true;
+    ClearQueue();
+  }
+}
+
+void REShaderPrewarm::Shutdown()
+{
+  FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+  TickerHandle.Reset();
+  if (Notification)
+  {
+    Notification->ExpireAndFadeout();
+    Notification.Reset();
+  }
+  ClearQueue();
+  InFlight.Empty();
+  LastImport.Empty();
+  Platforms.Empty();
+  NumTotal = 0;
+  NumDone = 0;
+  bCancelled = false;
+}
+
+bool REShaderPrewarm::IsRunning()
+{
+  return GetNumQueued() || InFlight.Num() || TickerHandle.IsValid();
+}
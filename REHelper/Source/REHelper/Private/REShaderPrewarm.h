@@ -0,0 +1,24 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "UObject/SoftObjectPath.h"
+
+// Compiles shader maps of imported materials for the target platforms in the background and stores them in the DDC,
+// so opening a level or editing a material later doesn't stall on shader compilation.
+// Platforms are REHelper.Prewarm.Platforms or the active target platforms (-TargetPlatform=...).
+// In commandlets and other sessions without a ticking editor loop the work is done right away.
+class REShaderPrewarm {
+public:
+  REShaderPrewarm() = delete;
+  ~REShaderPrewarm() = delete;
+
+  // Remember materials created by an import and prewarm them if REHelper.Prewarm is set.
+  // Takes paths, since batched imports unload materials before the import ends.
+  static void OnMaterialsImported(const TArray<FSoftObjectPath>& Materials);
+  // Queue materials. Adds them to the running prewarm if there is one. Unloaded materials are loaded when their turn comes.
+  static void Start(const TArray<FSoftObjectPath>& Materials);
+  // Stop queuing materials. Compiles in flight finish in the background.
+  static void Cancel();
+  // Drop everything without waiting. Used on module shutdown.
+  static void Shutdown();
+  static bool IsRunning();
+};
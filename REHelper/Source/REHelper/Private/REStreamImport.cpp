@@ -0,0 +1,247 @@
+#include "REStreamImport.h"
+#include "REDump.h"
+#include "REResolver.h"
+#include "REScanner.h"
+#include "REWorker.h"
+
+#include "Editor.h"
+#include "Factories/MaterialFactoryNew.h"
+#include "Factories/MaterialInstanceConstantFactoryNew.h"
+
+namespace
+{
+  inline void AppendLine(FString& Out, FAnsiStringView Line)
+  {
+    FUTF8ToTCHAR Converted(Line.GetData(), Line.Len());
+    Out.AppendChars(Converted.Get(), Converted.Length());
+    Out.AppendChars(TEXT("\r\n"), 2);
+  }
+
+  // Returns the second word of a T3D "Begin X"/"End X" line
+  inline FAnsiStringView GetBlockType(FAnsiStringView Trimmed)
+  {
+    int32 Space = INDEX_NONE;
+    if (!Trimmed.FindChar(' ', Space))
+    {
+      return FAnsiStringView();
+    }
+    FAnsiStringView Type = Trimmed.RightChop(Space + 1).TrimStart();
+    if (Type.FindChar(' ', Space))
+    {
+      Type = Type.Left(Space);
+    }
+    return Type;
+  }
+}
+
+FT3DChunkImporter::FT3DChunkImporter(UWorld* InWorld, int32 InActorsPerChunk)
+  : World(InWorld)
+  , ActorsPerChunk(FMath::Max(1, InActorsPerChunk))
+{}
+
+void FT3DChunkImporter::GatherReferences(FAnsiStringView Text, TSet<FString>& OutPaths)
+{
+  const ANSICHAR* End = Text.GetData() + Text.Len();
+  for (const ANSICHAR* Ptr = REScanner::FindChar(Text.GetData(), End, '/'); Ptr != End; Ptr = REScanner::FindChar(Ptr + 1, End, '/'))
+  {
+    if (End - Ptr < 6 || FCStringAnsi::Strnicmp(Ptr, "/Game/", 6))
+    {
+      continue;
+    }
+    const ANSICHAR* PathEnd = Ptr + 6;
+    while (PathEnd < End && !FCharAnsi::IsWhitespace(*PathEnd) && *PathEnd != '\'' && *PathEnd != '"' && *PathEnd != ',' && *PathEnd != ')')
+    {
+      PathEnd++;
+    }
+    OutPaths.Add(REDump::ToFString(FAnsiStringView(Ptr, (int32)(PathEnd - Ptr))));
+    Ptr = PathEnd - 1;
+  }
+}
+
+bool FT3DChunkImporter::AddLine(FAnsiStringView Line)
+{
+  const FAnsiStringView Trimmed = Line.TrimStartAndEnd();
+  if (!bValid)
+  {
+    if (Trimmed.IsEmpty())
+    {
+      return true;
+    }
+    if (!Trimmed.StartsWith("BEGIN MAP", ESearchCase::IgnoreCase))
+    {
+      return false;
+    }
+    bValid = true;
+  }
+
+  TSet<FString> References;
+  GatherReferences(Line, References);
+  for (FString& Reference : References)
+  {
+    bool bSeen = false;
+    SeenReferences.Add(Reference, &bSeen);
+    if (!bSeen)
+    {
+      ChunkReferences.Add(MoveTemp(Reference));
+    }
+  }
+
+  if (bInActor)
+  {
+    AppendLine(Chunk, Line);
+    if (Trimmed.StartsWith("END ACTOR", ESearchCase::IgnoreCase))
+    {
+      bInActor = false;
+      if (++ChunkActors >= ActorsPerChunk)
+      {
+        PasteChunk();
+      }
+    }
+    return true;
+  }
+
+  if (Trimmed.StartsWith("BEGIN ACTOR", ESearchCase::IgnoreCase))
+  {
+    if (!bHeaderDone)
+    {
+      bHeaderDone = true;
+      for (int32 Idx = FooterLines.Num() - 1; Idx >= 0; --Idx)
+      {
+        Footer += FooterLines[Idx];
+      }
+      Chunk += Header;
+    }
+    bInActor = true;
+    bChunkHasContent = true;
+    AppendLine(Chunk, Line);
+    return true;
+  }
+
+  const bool bBegin = Trimmed.StartsWith("BEGIN ", ESearchCase::IgnoreCase);
+  const bool bEnd = Trimmed.StartsWith("END ", ESearchCase::IgnoreCase);
+  if (!bHeaderDone)
+  {
+    AppendLine(Header, Line);
+    if (bBegin)
+    {
+      FString FooterLine = TEXT("END ");
+      AppendLine(FooterLine, GetBlockType(Trimmed));
+      FooterLines.Add(MoveTemp(FooterLine));
+    }
+    return true;
+  }
+
+  // Non-actor blocks between actors belong to the level. Closing header blocks are replaced by the Footer.
+  if (bBegin)
+  {
+    BlockDepth++;
+  }
+  else if (bEnd)
+  {
+    if (!BlockDepth)
+    {
+      return true;
+    }
+    BlockDepth--;
+  }
+  if (!Trimmed.IsEmpty())
+  {
+    AppendLine(Chunk, Line);
+    bChunkHasContent = true;
+  }
+  return true;
+}
+
+void FT3DChunkImporter::Flush()
+{
+  PasteChunk();
+}
+
+void FT3DChunkImporter::PasteChunk()
+{
+  if (!bChunkHasContent)
+  {
+    return;
+  }
+  Chunk += Footer;
+  // Loading them together is much faster than letting the paste load them one by one
+  REResolver::Preload(ChunkReferences);
+  ChunkReferences.Reset();
+  GEditor->edactPasteSelected(World, false, false, bFirstPaste, &Chunk);
+  GEditor->SelectNone(false, true, false);
+  bFirstPaste = false;
+  bChunkHasContent = false;
+  Result += ChunkActors;
+  ChunkActors = 0;
+  Chunk.Reset();
+  Chunk += Header;
+}
+
+FMaterialStreamImporter::FMaterialStreamImporter()
+  : MatFactory(NewObject<UMaterialFactoryNew>())
+  , MiFactory(NewObject<UMaterialInstanceConstantFactoryNew>())
+{}
+
+FMaterialStreamImporter::~FMaterialStreamImporter() = default;
+
+void FMaterialStreamImporter::Add(TArray<RMaterial>&& NewMaterials)
+{
+  for (RMaterial& NewMaterial : NewMaterials)
+  {
+    RMaterial* Material = new RMaterial(MoveTemp(NewMaterial));
+    Materials.Add(Material);
+    ByName.Add(Material->Name, Material);
+    if (!Material->ParentName.Len())
+    {
+      Ready.Add(Material);
+      continue;
+    }
+    RMaterial** Parent = ByName.Find(Material->ParentName);
+    if (Parent && (*Parent)->UnrealMaterial)
+    {
+      Material->Parent = *Parent;
+      Ready.Add(Material);
+    }
+    else
+    {
+      Waiting.Add(Material->ParentName, Material);
+    }
+  }
+  NewMaterials.Reset();
+}
+
+bool FMaterialStreamImporter::Process(double TimeLimit)
+{
+  const double EndTime = FPlatformTime::Seconds() + TimeLimit;
+  // Children are appended to Ready while it's processed. Keep the file order within a batch.
+  int32 Idx = 0;
+  for (; Idx < Ready.Num() && FPlatformTime::Seconds() < EndTime; ++Idx)
+  {
+    RMaterial* Material = Ready[Idx];
+    bool bError = false;
+    Created.Append(REWorker::ImportMaterial(Material, MatFactory.Get(), MiFactory.Get(), bError));
+    bErrors |= bError;
+
+    TArray<RMaterial*> Children;
+    Waiting.MultiFind(Material->Name, Children, true);
+    Waiting.Remove(Material->Name);
+    for (RMaterial* Child : Children)
+    {
+      Child->Parent = Material;
+      Ready.Add(Child);
+    }
+  }
+  Ready.RemoveAt(0, Idx, false);
+  return !Ready.Num();
+}
+
+void FMaterialStreamImporter::Finish()
+{
+  Process(MAX_dbl);
+  for (const TPair<FString, RMaterial*>& Pair : Waiting)
+  {
+    UE_LOG(LogTemp, Error, TEXT("RE Helper: Failed to find parent material \"%s\" for \"%s\". For some reasons Real Editor didn't include it in the dump file."), *Pair.Key, *Pair.Value->Name);
+    bErrors = true;
+  }
+  Waiting.Empty();
+}
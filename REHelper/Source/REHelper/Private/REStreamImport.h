@@ -0,0 +1,94 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Containers/StringView.h"
+#include "UObject/StrongObjectPtr.h"
+
+struct RMaterial;
+class UMaterialFactoryNew;
+class UMaterialInstanceConstantFactoryNew;
+
+// Pastes T3D actors to a World in chunks while the dump is being read.
+// Everything before the first actor (BEGIN MAP, BEGIN LEVEL...) is repeated for every chunk.
+// Footer closes the header blocks in reverse order.
+// Assets referenced by a chunk are preloaded right before it's pasted, so the dump is read only once.
+class FT3DChunkImporter {
+public:
+  FT3DChunkImporter(UWorld* InWorld, int32 InActorsPerChunk);
+
+  // Object paths under /Game/ referenced by T3D text, e.g. StaticMesh=StaticMesh'/Game/Foo/Bar.Bar'
+  static void GatherReferences(FAnsiStringView Text, TSet<FString>& OutPaths);
+
+  // Feed the next line. Returns false if the dump is not a valid T3D.
+  bool AddLine(FAnsiStringView Line);
+  // Paste the remaining actors
+  void Flush();
+
+  // True once "BEGIN MAP" was found
+  bool IsValid() const
+  {
+    return bValid;
+  }
+
+  // Number of pasted actors
+  int32 GetNumActors() const
+  {
+    return Result;
+  }
+
+private:
+  void PasteChunk();
+
+  UWorld* World = nullptr;
+  int32 ActorsPerChunk = 1;
+  FString Header;
+  TArray<FString> FooterLines;
+  FString Footer;
+  FString Chunk;
+  // References first seen in the current chunk
+  TArray<FString> ChunkReferences;
+  TSet<FString> SeenReferences;
+  bool bValid = false;
+  bool bHeaderDone = false;
+  bool bInActor = false;
+  bool bChunkHasContent = false;
+  bool bFirstPaste = true;
+  int32 BlockDepth = 0;
+  int32 ChunkActors = 0;
+  int32 Result = 0;
+};
+
+// Creates materials from a dump that arrives in parts. Master materials are created right away,
+// instances as soon as their parent exists.
+class FMaterialStreamImporter {
+public:
+  FMaterialStreamImporter();
+  ~FMaterialStreamImporter();
+
+  void Add(TArray<RMaterial>&& Materials);
+  // Create ready materials until the time limit in seconds is exceeded. Returns false if some materials are still ready to be created.
+  bool Process(double TimeLimit);
+  // The dump is complete. Create what's left and report materials with missing parents.
+  void Finish();
+
+  const TArray<UObject*>& GetCreated() const
+  {
+    return Created;
+  }
+
+  bool HadErrors() const
+  {
+    return bErrors;
+  }
+
+private:
+  // Stable storage. Records reference their parents by pointer.
+  TIndirectArray<RMaterial> Materials;
+  TMap<FString, RMaterial*> ByName;
+  // Waiting for the parent by parent name
+  TMultiMap<FString, RMaterial*> Waiting;
+  TArray<RMaterial*> Ready;
+  TArray<UObject*> Created;
+  TStrongObjectPtr<UMaterialFactoryNew> MatFactory;
+  TStrongObjectPtr<UMaterialInstanceConstantFactoryNew> MiFactory;
+  bool bErrors = false;
+};
@@ -0,0 +1,417 @@
+#include "REValidator.h"
+#include "REDump.h"
+#include "REResolver.h"
+#include "Core/REDumpCore.h"
+
+#include "Async/ParallelFor.h"
+#include "Engine/Texture.h"
+#include "HAL/IConsoleManager.h"
+#include "Materials/MaterialInterface.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+#include "Misc/MessageDialog.h"
+#include "Misc/Paths.h"
+#include "Sound/SoundWave.h"
+
+namespace
+{
+  TAutoConsoleVariable<int32> CVarValidate(
+    TEXT("REHelper.Validate"),
+    1,
+    TEXT("Validate dump references before an import.\n")
+    TEXT("0: off\n")
+    TEXT("1: log problems and save the report\n")
+    TEXT("2: also ask whether to continue if referenced assets are missing\n")
+    TEXT("3: stop the import if referenced assets are missing"));
+
+  // Problems listed in the dialog. The full list goes to the log and the report file.
+  const int32 MaxDialogLines = 20;
+
+  inline bool IsNone(const FString& Path)
+  {
+    return !Path.Len() || Path == TEXT("None");
+  }
+
+  void AddReference(TArray<FDumpReference>& References, const FString& Path, UClass* Class, const FString& Owner, bool bOptional = false)
+  {
+    if (!IsNone(Path))
+    {
+      References.Add({ Path, Class, Owner, bOptional });
+    }
+  }
+
+  // Entries that normalize to the same asset path
+  template <typename TRecord>
+  void FindDuplicates(const TArray<TRecord>& Records, TFunctionRef<const FString&(const TRecord&)> GetName, const TCHAR* What, FValidationReport& Report)
+  {
+    TSet<FString> Names;
+    Names.Reserve(Records.Num());
+    for (const TRecord& Record : Records)
+    {
+      bool bDuplicate = false;
+      Names.Add(REResolver::NormalizePath(GetName(Record)), &bDuplicate);
+      if (bDuplicate)
+      {
+        Report.Ambiguous.Add(FString::Printf(TEXT("%s \"%s\" is defined more than once"), What, *GetName(Record)));
+      }
+    }
+  }
+
+  void GatherMaterials(const TArray<RMaterial>& Materials, TArray<FDumpReference>& OutReferences, FValidationReport& Report)
+  {
+    FindDuplicates<RMaterial>(Materials, [](const RMaterial& Material) -> const FString& { return Material.Name; }, TEXT("Material"), Report);
+    TSet<FString> Names;
+    Names.Reserve(Materials.Num());
+    for (const RMaterial& Material : Materials)
+    {
+      Names.Add(Material.Name);
+    }
+    UClass* TextureClass = UTexture::StaticClass();
+    for (const RMaterial& Material : Materials)
+    {
+      if (Material.ParentName.Len() && !Names.Contains(Material.ParentName))
+      {
+        Report.Missing.Add(FString::Printf(TEXT("Parent material \"%s\" of \"%s\" is not in the dump"), *Material.ParentName, *Material.Name));
+      }
+      for (const TPair<FName, FName>& P : Material.TextureParameters)
+      {
+        AddReference(OutReferences, P.Value.ToString(), TextureClass, FString::Printf(TEXT("%s of material \"%s\""), *P.Key.ToString(), *Material.Name));
+      }
+      for (const TPair<FName, FName>& P : Material.TextureAParameters)
+      {
+        AddReference(OutReferences, P.Value.ToString(), TextureClass, FString::Printf(TEXT("%s of material \"%s\""), *P.Key.ToString(), *Material.Name));
+      }
+    }
+  }
+
+  // Textures.txt lists every texture of a package. FixTextures skips the ones that were never imported.
+  void GatherTextures(const TArray<RTexture>& Textures, TArray<FDumpReference>& OutReferences, FValidationReport& Report)
+  {
+    FindDuplicates<RTexture>(Textures, [](const RTexture& Texture) -> const FString& { return Texture.Name; }, TEXT("Texture"), Report);
+    for (const RTexture& Texture : Textures)
+    {
+      AddReference(OutReferences, Texture.Name, UTexture::StaticClass(), TEXT("Textures.txt"), true);
+    }
+  }
+
+  void GatherDefaultMaterials(const TArray<RDefaultMaterials>& Entries, TArray<FDumpReference>& OutReferences, FValidationReport& Report)
+  {
+    FindDuplicates<RDefaultMaterials>(Entries, [](const RDefaultMaterials& Entry) -> const FString& { return Entry.Name; }, TEXT("Mesh"), Report);
+    for (const RDefaultMaterials& Entry : Entries)
+    {
+      AddReference(OutReferences, Entry.Name, UObject::StaticClass(), TEXT("DefaultMaterials.txt"));
+      for (int32 Slot = 0; Slot < Entry.Materials.Num(); ++Slot)
+      {
+        AddReference(OutReferences, Entry.Materials[Slot], UMaterialInterface::StaticClass(), FString::Printf(TEXT("slot %d of \"%s\""), Slot, *Entry.Name));
+      }
+    }
+  }
+
+  void GatherSpeedTreeOverrides(const TArray<RSpeedTreeOverride>& Entries, TArray<FDumpReference>& OutReferences, FValidationReport& Report)
+  {
+    FindDuplicates<RSpeedTreeOverride>(Entries, [](const RSpeedTreeOverride& Entry) -> const FString& { return Entry.ActorName; }, TEXT("Actor"), Report);
+    for (const RSpeedTreeOverride& Entry : Entries)
+    {
+      for (const RMaterialOverride& Override : Entry.Overrides)
+      {
+        AddReference(OutReferences, Override.Material, UMaterialInterface::StaticClass(), FString::Printf(TEXT("slot %s of actor \"%s\""), *Override.Slot, *Entry.ActorName));
+      }
+    }
+  }
+
+  void GatherCues(const TArray<FDumpCue>& Entries, TArray<FDumpReference>& OutReferences, FValidationReport& Report)
+  {
+    TSet<FString> Cues;
+    for (const FDumpCue& Entry : Entries)
+    {
+      if (Entry.bEmpty)
+      {
+        Report.Missing.Add(FString::Printf(TEXT("SoundCue file \"%s\" is missing or empty"), *Entry.File));
+        continue;
+      }
+      if (!Entry.bParsed)
+      {
+        Report.Missing.Add(FString::Printf(TEXT("SoundCue file \"%s\" is malformed: %s"), *Entry.File, Entry.ParseError ? UTF8_TO_TCHAR(Entry.ParseError) : TEXT("no in-game path")));
+        continue;
+      }
+      const FString Path = REDump::ToFString(FAnsiStringView(Entry.Cue.Path.data(), (int32)Entry.Cue.Path.size()));
+      bool bDuplicate = false;
+      Cues.Add(REResolver::NormalizePath(Path), &bDuplicate);
+      if (bDuplicate)
+      {
+        Report.Ambiguous.Add(FString::Printf(TEXT("SoundCue \"%s\" is defined more than once"), *Path));
+      }
+      for (const REDumpCore::CueNode& Node : Entry.Cue.Nodes)
+      {
+        for (const REDumpCore::CueProperty& Property : Node.Properties)
+        {
+          if (REDumpCore::Equals(Property.Key, "Sound"))
+          {
+            AddReference(OutReferences, REDump::ToFString(FAnsiStringView(Property.Value.data(), (int32)Property.Value.size())), USoundWave::StaticClass(), FString::Printf(TEXT("SoundCue \"%s\""), *Path));
+          }
+        }
+      }
+    }
+  }
+
+  // Log the report, save it and decide whether to go on
+  bool Confirm(const FString& Path, const FValidationReport& Report)
+  {
+    if (!Report.HasProblems())
+    {
+      UE_LOG(LogTemp, Display, TEXT("RE Helper: Validated \"%s\": %s"), *Path, *Report.GetSummary());
+      return true;
+    }
+    const FString Text = Report.ToString();
+    UE_LOG(LogTemp, Warning, TEXT("RE Helper: Validation of \"%s\" found problems: %s\n%s"), *Path, *Report.GetSummary(), *Text);
+    const FString ReportPath = REValidator::GetReportPath();
+    FFileHelper::SaveStringToFile(FString::Printf(TEXT("%s\n%s\n%s"), *Path, *Report.GetSummary(), *Text), *ReportPath);
+
+    const int32 Mode = CVarValidate.GetValueOnGameThread();
+    if (Mode < 2 || !Report.Missing.Num())
+    {
+      return true;
+    }
+    if (Mode >= 3)
+    {
+      return false;
+    }
+    if (FApp::IsUnattended())
+    {
+      return true;
+    }
+
+    TArray<FString> Lines;
+    Text.ParseIntoArrayLines(Lines);
+    FString Message = Report.GetSummary() + TEXT("\n\n");
+    for (int32 Idx = 0; Idx < Lines.Num() && Idx < MaxDialogLines; ++Idx)
+    {
+      Message += Lines[Idx] + TEXT("\n");
+    }
+    if (Lines.Num() > MaxDialogLines)
+    {
+      Message += FString::Printf(TEXT("...and %d more.\n"), Lines.Num() - MaxDialogLines);
+    }
+    Message += FString::Printf(TEXT("\nThe full report is saved to \"%s\".\n\nContinue the import anyway?"), *FPaths::ConvertRelativePathToFull(ReportPath));
+    const FText Title = FText::FromString(TEXT("Validation"));
+    return FMessageDialog::Open(EAppMsgType::YesNo, FText::FromString(Message), &Title) == EAppReturnType::Yes;
+  }
+
+  bool RunPreflight(const FString& Path, TFunctionRef<void(TArray<FDumpReference>&, FValidationReport&)> Gather)
+  {
+    if (!CVarValidate.GetValueOnGameThread())
+    {
+      return true;
+    }
+    const double StartTime = FPlatformTime::Seconds();
+    TArray<FDumpReference> References;
+    FValidationReport Report;
+    Gather(References, Report);
+    REValidator::Check(References, Report);
+    UE_LOG(LogTemp, Display, TEXT("RE Helper: Validated %d references in %.2f ms"), Report.NumReferences, (FPlatformTime::Seconds() - StartTime) * 1000.);
+    return Confirm(Path, Report);
+  }
+
+  void ValidateCommand(const TArray<FString>& Args)
+  {
+    if (!Args.Num())
+    {
+      UE_LOG(LogTemp, Warning, TEXT("RE Helper: Usage: REHelper.ValidateDumps <Path to a dump file> [<Path>...]"));
+      return;
+    }
+    const FValidationReport Report = REValidator::ValidateFiles(Args);
+    if (Report.HasProblems())
+    {
+      UE_LOG(LogTemp, Warning, TEXT("RE Helper: Validation found problems: %s\n%s"), *Report.GetSummary(), *Report.ToString());
+      FFileHelper::SaveStringToFile(Report.GetSummary() + TEXT("\n") + Report.ToString(), *REValidator::GetReportPath());
+    }
+    else
+    {
+      UE_LOG(LogTemp, Display, TEXT("RE Helper: Validation passed: %s"), *Report.GetSummary());
+    }
+  }
+
+  FAutoConsoleCommand ValidateDumpsCommand(
+    TEXT("REHelper.ValidateDumps"),
+    TEXT("Check references of RE dump files without importing anything. Usage: REHelper.ValidateDumps <Path to a dump file> [<Path>...]"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&ValidateCommand));
+}
+
+FString FValidationReport::GetSummary() const
+{
+  return FString::Printf(TEXT("%d references, %d missing, %d of a wrong type, %d ambiguous"), NumReferences, Missing.Num(), WrongClass.Num(), Ambiguous.Num());
+}
+
+FString FValidationReport::ToString() const
+{
+  FString Result;
+  for (const FString& Line : Missing)
+  {
+    Result += TEXT("Missing: ") + Line + TEXT("\n");
+  }
+  for (const FString& Line : WrongClass)
+  {
+    Result += TEXT("Wrong type: ") + Line + TEXT("\n");
+  }
+  for (const FString& Line : Ambiguous)
+  {
+    Result += TEXT("Ambiguous: ") + Line + TEXT("\n");
+  }
+  return Result;
+}
+
+bool REValidator::Preflight(const FString& Path, const TArray<RMaterial>& Materials)
+{
+  return RunPreflight(Path, [&](TArray<FDumpReference>& References, FValidationReport& Report) {
+    GatherMaterials(Materials, References, Report);
+  });
+}
+
+bool REValidator::Preflight(const FString& Path, const TArray<RTexture>& Textures)
+{
+  return RunPreflight(Path, [&](TArray<FDumpReference>& References, FValidationReport& Report) {
+    GatherTextures(Textures, References, Report);
+  });
+}
+
+bool REValidator::Preflight(const FString& Path, const TArray<RDefaultMaterials>& Entries)
+{
+  return RunPreflight(Path, [&](TArray<FDumpReference>& References, FValidationReport& Report) {
+    GatherDefaultMaterials(Entries, References, Report);
+  });
+}
+
+bool REValidator::Preflight(const FString& Path, const TArray<RSpeedTreeOverride>& Entries)
+{
+  return RunPreflight(Path, [&](TArray<FDumpReference>& References, FValidationReport& Report) {
+    GatherSpeedTreeOverrides(Entries, References, Report);
+  });
+}
+
+bool REValidator::PreflightCues(const FString& Path, const TArray<FDumpCue>& Cues)
+{
+  return RunPreflight(Path, [&](TArray<FDumpReference>& References, FValidationReport& Report) {
+    GatherCues(Cues, References, Report);
+  });
+}
+
+FValidationReport REValidator::ValidateFiles(const TArray<FString>& Paths)
+{
+  FScopedResolverCache ResolverCache;
+  FValidationReport Report;
+  TArray<FDumpReference> References;
+  for (const FString& Path : Paths)
+  {
+    FString Name = FPaths::GetCleanFilename(Path);
+    Name.RemoveFromEnd(TEXT(".gz"));
+    bool bErrors = false;
+    bool bLoaded = false;
+    if (Name.StartsWith(TEXT("MaterialsList")))
+    {
+      TArray<RMaterial> Materials;
+      bLoaded = REDump::LoadMaterials(Path, Materials, bErrors);
+      GatherMaterials(Materials, References, Report);
+    }
+    else if (Name.StartsWith(TEXT("Textures")))
+    {
+      TArray<RTexture> Textures;
+      bLoaded = REDump::LoadTextures(Path, Textures, bErrors);
+      GatherTextures(Textures, References, Report);
+    }
+    else if (Name.StartsWith(TEXT("DefaultMaterials")))
+    {
+      TArray<RDefaultMaterials> Entries;
+      bLoaded = REDump::LoadDefaultMaterials(Path, Entries, bErrors);
+      GatherDefaultMaterials(Entries, References, Report);
+    }
+    else if (Name.StartsWith(TEXT("SpeedTreeOverrides")))
+    {
+      TArray<RSpeedTreeOverride> Entries;
+      bLoaded = REDump::LoadSpeedTreeOverrides(Path, Entries, bErrors);
+      GatherSpeedTreeOverrides(Entries, References, Report);
+    }
+    else if (Name.EndsWith(TEXT(".cue")))
+    {
+      bLoaded = true;
+      TArray<FDumpCue> Cues;
+      REDump::ParseCues({ Path }, Cues);
+      GatherCues(Cues, References, Report);
+    }
+    else if (Name.StartsWith(TEXT("Cues")))
+    {
+      FDumpText Text;
+      TArray<FString> CuePaths;
+      bLoaded = REDump::LoadText(Path, Text);
+      for (const FAnsiStringView& Line : Text.Lines)
+      {
+        if (!Line.StartsWith(' ') && Line.Len() > 2)
+        {
+          CuePaths.Add(REDump::ToFString(Line));
+        }
+      }
+      TArray<FDumpCue> Cues;
+      REDump::ParseCues(CuePaths, Cues);
+      GatherCues(Cues, References, Report);
+    }
+    else
+    {
+      UE_LOG(LogTemp, Warning, TEXT("RE Helper: Can't tell the kind of \"%s\". Skipping it."), *Path);
+      continue;
+    }
+    if (!bLoaded)
+    {
+      Report.Missing.Add(FString::Printf(TEXT("Dump file \"%s\" is missing or empty"), *Path));
+    }
+    else if (bErrors)
+    {
+      Report.Missing.Add(FString::Printf(TEXT("Dump file \"%s\" has malformed entries. See the log for the lines."), *Path));
+    }
+  }
+  Check(References, Report);
+  return Report;
+}
+
+void REValidator::Check(const TArray<FDumpReference>& References, FValidationReport& Report)
+{
+  TArray<FString> Paths;
+  Paths.Reserve(References.Num());
+  for (const FDumpReference& Reference : References)
+  {
+    Paths.Add(Reference.Path);
+  }
+  // Registry queries happen here. The lookups below only read the index.
+  REResolver::PreIndex(Paths);
+
+  TArray<REResolver::EIndexState> States;
+  States.SetNumUninitialized(References.Num());
+  ParallelFor(References.Num(), [&](int32 Idx) {
+    States[Idx] = REResolver::GetIndexState(References[Idx].Path, References[Idx].Class);
+  });
+  // Assets that are not saved yet aren't indexed. Loaded objects can only be searched on the game thread.
+  for (int32 Idx = 0; Idx < References.Num(); ++Idx)
+  {
+    if (States[Idx] == REResolver::EIndexState::Missing)
+    {
+      States[Idx] = REResolver::GetLoadedState(References[Idx].Path, References[Idx].Class);
+    }
+  }
+
+  Report.NumReferences += References.Num();
+  for (int32 Idx = 0; Idx < References.Num(); ++Idx)
+  {
+    const FDumpReference& Reference = References[Idx];
+    if (States[Idx] == REResolver::EIndexState::Missing && !Reference.bOptional)
+    {
+      Report.Missing.Add(FString::Printf(TEXT("%s \"%s\" referenced by %s"), *Reference.Class->GetName(), *Reference.Path, *Reference.Owner));
+    }
+    else if (States[Idx] == REResolver::EIndexState::WrongClass)
+    {
+      Report.WrongClass.Add(FString::Printf(TEXT("\"%s\" referenced by %s is not a %s"), *Reference.Path, *Reference.Owner, *Reference.Class->GetName()));
+    }
+  }
+}
+
+FString REValidator::GetReportPath()
+{
+  return FPaths::ProjectSavedDir() / TEXT("REHelper") / TEXT("ValidationReport.txt");
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include "CoreMinimal.h"
+
+struct RMaterial;
+struct RTexture;
+struct RDefaultMaterials;
+struct RSpeedTreeOverride;
+struct FDumpCue;
+
+// A reference from a dump entry to an asset
+struct FDumpReference {
+  FString Path;
+  UClass* Class = nullptr;
+  // Dump entry that holds the reference
+  FString Owner;
+  // Dumps may list assets that were never imported. Only a wrong class is a problem.
+  bool bOptional = false;
+};
+
+// Problems found in dumps before anything is created
+struct FValidationReport {
+  // References to assets that don't exist
+  TArray<FString> Missing;
+  // References to assets of an unexpected class
+  TArray<FString> WrongClass;
+  // Entries that define the same asset more than once
+  TArray<FString> Ambiguous;
+  int32 NumReferences = 0;
+
+  bool HasProblems() const
+  {
+    return Missing.Num() || WrongClass.Num() || Ambiguous.Num();
+  }
+
+  FString GetSummary() const;
+  FString ToString() const;
+};
+
+// Pre-flight validation of RE dumps. Cross-references are checked against the REResolver index in parallel,
+// so a complete report is ready before any material or shader work starts.
+// Needs an FScopedResolverCache.
+class REValidator {
+public:
+  REValidator() = delete;
+  ~REValidator() = delete;
+
+  // Validate parsed dumps. Depending on REHelper.Validate asks whether to continue if assets are missing.
+  // Returns false if the import should stop.
+  static bool Preflight(const FString& Path, const TArray<RMaterial>& Materials);
+  static bool Preflight(const FString& Path, const TArray<RTexture>& Textures);
+  static bool Preflight(const FString& Path, const TArray<RDefaultMaterials>& Entries);
+  static bool Preflight(const FString& Path, const TArray<RSpeedTreeOverride>& Entries);
+  // Cues are the parsed .cue files listed in a Cues.txt
+  static bool PreflightCues(const FString& Path, const TArray<FDumpCue>& Cues);
+
+  // Parse dump files of any kind and validate them together. The kind is detected by the file name.
+  static FValidationReport ValidateFiles(const TArray<FString>& Paths);
+
+  // Check references against the asset registry index
+  static void Check(const TArray<FDumpReference>& References, FValidationReport& Report);
+
+  static FString GetReportPath();
+};
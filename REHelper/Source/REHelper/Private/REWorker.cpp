@@ -1,6 +1,18 @@
 #include "REWorker.h"
+#include "REAssetBatch.h"
+#include "REImportBatch.h"
+#include "REPackageSaver.h"
+#include "REDump.h"
+#include "REDumpStream.h"
+#include "REScanner.h"
+#include "REResolver.h"
+#include "REShaderPrewarm.h"
+#include "REStreamImport.h"
+#include "REValidator.h"
+#include "Core/REDumpCore.h"
 
 #include "MaterialShared.h"
+#include "ShaderCompiler.h"
 #include "ObjectTools.h"
 
 #include "Factories/MaterialFactoryNew.h"
@@ -35,270 +47,557 @@
 
 #include "SoundCueGraph/SoundCueGraphNode.h"
 
+#include "Containers/StringView.h"
+#include "Editor.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFileManager.h"
 #include "Misc/FileHelper.h"
+#include "Misc/ScopeExit.h"
 #include "Misc/ScopedSlowTask.h"
 #include "AssetRegistryModule.h"
 #include "AssetToolsModule.h"
 #include "IAssetTools.h"
 #include "PackageTools.h"
 #include "Engine/TextureCube.h"
+#include "UObject/UObjectIterator.h"
 #include "Engine/StaticMeshActor.h"
 
 namespace
 {
-  // Value separator in RE dumps. Must match RE implementation.
-  const TCHAR* VSEP = TEXT("\t");
-
-  inline void FixObjectName(FString& Name)
-  {
-    Name.RemoveFromStart(TEXT("/"));
-    Name.RemoveFromStart(TEXT("Content/"));
-    Name.StartsWith(TEXT("Game/")) == true ? Name.InsertAt(0, TEXT("/")) : Name.InsertAt(0, TEXT("/Game/"));
-  }
-
-  template <typename T>
-  T* FindResource(FString Name)
+  inline FString ToFString(std::string_view View)
   {
-    FixObjectName(Name);
-    // FindObject for some reasons doesn't like untyped search. Use LoadObject<T>() instead. 
-    return LoadObject<T>(nullptr, *Name);
+    return REDump::ToFString(FAnsiStringView(View.data(), (int32)View.size()));
   }
 
-  template <typename T>
-  T* CreateAsset(FString Name, UFactory* Factory)
-  {
-    FixObjectName(Name);
-
-    FString PackageName;
-    IAssetTools& AssetTools = FModuleManager::Get().LoadModuleChecked<FAssetToolsModule>("AssetTools").Get();
-
-    AssetTools.CreateUniqueAssetName(Name, TEXT(""), PackageName, Name);
-    
-    if (T* Asset = Cast<T>(AssetTools.CreateAsset(Name, FPackageName::GetLongPackagePath(PackageName), T::StaticClass(), Factory)))
-    {
-      FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry");
-      AssetRegistryModule.Get().AssetCreated(Asset);
-      return Asset;
-    }
-    
-    return nullptr;
-  }
-}
+  TAutoConsoleVariable<int32> CVarStreamT3D(
+    TEXT("REHelper.T3D.Streaming"),
+    1,
+    TEXT("Import T3D files in chunks of actors instead of pasting the whole file at once."));
 
-struct RMaterial {
-  FString Name;
-  FString Class;
-  FString ParentName;
+  TAutoConsoleVariable<int32> CVarT3DActorsPerChunk(
+    TEXT("REHelper.T3D.ActorsPerChunk"),
+    256,
+    TEXT("Number of actors pasted at once during a streaming T3D import."));
 
-  TMap<FString, bool> BoolParameters;
-  TMap<FString, float> ScalarParameters;
-  TMap<FString, FString> TextureParameters;
-  TMap<FString, FString> TextureAParameters;
-  TMap<FString, FLinearColor> VectorParameters;
+  TAutoConsoleVariable<int32> CVarParallelTextures(
+    TEXT("REHelper.Textures.Parallel"),
+    1,
+    TEXT("Rebuild textures changed by FixTextures on worker threads instead of one by one on the game thread."));
 
-  bool TwoSided = false;
+  TAutoConsoleVariable<int32> CVarTexturesInFlight(
+    TEXT("REHelper.Textures.MaxInFlight"),
+    0,
+    TEXT("Textures rebuilt at once by FixTextures. 0 for the number of logical cores."));
 
-  RMaterial* Parent = nullptr;
-  UObject* UnrealMaterial = nullptr;
+  // Textures updated together once their platform data is built
+  const int32 TextureCommitBatch = 64;
 
-  // Serialize from RE dump. Modifies Idx. Returns false on error.
-  bool ReadFromArray(const TArray<FString>& Lines, int32& Idx)
+  // Rebuild textures on worker threads. The render resource of a texture is released before its platform data is rebuilt
+  // and recreated once the data is ready, like UTexture::UpdateResource does. Materials are notified once for all textures.
+  void RebuildTextures(const TArray<UTexture*>& Textures, FScopedSlowTask& Task)
   {
-    const FString& Line = Lines[Idx];
-    if (!Line.Len())
+    const int32 MaxInFlight = CVarTexturesInFlight.GetValueOnGameThread() > 0 ? CVarTexturesInFlight.GetValueOnGameThread() : FPlatformMisc::NumberOfCoresIncludingHyperthreads();
+    TArray<UTexture*> InFlight;
+    TArray<UTexture*> Ready;
+    int32 Next = 0;
+    while (Next < Textures.Num() || InFlight.Num() || Ready.Num())
     {
-      return false;
+      while (Next < Textures.Num() && InFlight.Num() < MaxInFlight)
+      {
+        UTexture* Texture = Textures[Next++];
+        Texture->ReleaseResource();
+        Texture->BeginCachePlatformData();
+        InFlight.Add(Texture);
+      }
+      for (int32 Idx = InFlight.Num() - 1; Idx >= 0; --Idx)
+      {
+        if (InFlight[Idx]->IsAsyncCacheComplete())
+        {
+          Ready.Add(InFlight[Idx]);
+          InFlight.RemoveAtSwap(Idx);
+        }
+      }
+      if (Ready.Num() >= TextureCommitBatch || (Ready.Num() && !InFlight.Num()))
+      {
+        for (UTexture* Texture : Ready)
+        {
+          Texture->FinishCachePlatformData();
+          // Platform data is up to date, so this only creates the render resource
+          Texture->UpdateResource();
+          Texture->GetPackage()->SetDirtyFlag(true);
+          FAssetRegistryModule::AssetCreated(Texture);
+        }
+        Task.EnterProgressFrame((float)Ready.Num());
+        Ready.Reset();
+      }
+      else if (InFlight.Num())
+      {
+        FPlatformProcess::Sleep(0.01f);
+      }
     }
 
-    int32 Pos1 = Line.Find(TEXT(" "));
-    int32 Pos2 = 0;
-
-    if (Pos1 == INDEX_NONE)
+    // UTexture::NotifyMaterials for all textures at once
+    TSet<UTexture*> Changed(Textures);
+    TSet<UMaterial*> BaseMaterials;
+    FMaterialUpdateContext UpdateContext;
+    for (TObjectIterator<UMaterialInterface> It; It; ++It)
     {
-      return false;
+      TArray<UTexture*> Used;
+      It->GetUsedTextures(Used, EMaterialQualityLevel::Num, true, GMaxRHIFeatureLevel, true);
+      for (UTexture* Texture : Used)
+      {
+        if (Changed.Contains(Texture))
+        {
+          UpdateContext.AddMaterialInterface(*It);
+          BaseMaterials.Add(It->GetMaterial());
+          break;
+        }
+      }
     }
+    for (UMaterial* Material : BaseMaterials)
+    {
+      Material->PostEditChange();
+    }
+  }
 
-    Class = Line.Mid(0, Pos1);
+  TAutoConsoleVariable<int32> CVarBatchMeshBuild(
+    TEXT("REHelper.BatchMeshBuild"),
+    1,
+    TEXT("Rebuild meshes changed by AssignDefaultMaterials together once the whole file is applied."));
 
-    if (Class == "Material")
+  TAutoConsoleVariable<int32> CVarDeferMaterialCompile(
+    TEXT("REHelper.DeferMaterialCompile"),
+    1,
+    TEXT("Compile imported materials together once all of them exist.\n")
+    TEXT("0: compile every material as it's created\n")
+    TEXT("1: compile together and wait for the shaders\n")
+    TEXT("2: compile together and let the shaders finish in the background"));
+
+  // Materials created during an import. PostEditChange of every material flushes the render thread and
+  // recreates render states of all components, so the materials are compiled in a single FMaterialUpdateContext instead.
+  class FDeferredMaterialCompile {
+  public:
+    FDeferredMaterialCompile()
     {
-      ParentName.Empty();
-      Name = Line.Mid(Pos1 + 1);
+      if (CVarDeferMaterialCompile.GetValueOnGameThread() && !Active)
+      {
+        Active = this;
+      }
     }
-    else
+
+    ~FDeferredMaterialCompile()
     {
-      Pos2 = Line.Find(TEXT(" "), ESearchCase::IgnoreCase, ESearchDir::FromStart, Pos1 + 1);
-      if (Pos2 == INDEX_NONE)
+      if (Active == this)
       {
-        return false;
+        Active = nullptr;
       }
+    }
+
+    // Null if materials should be compiled right away
+    static FDeferredMaterialCompile* Get()
+    {
+      return Active;
+    }
+
+    void Add(UMaterial* Material)
+    {
+      // Instances created before the compile read parameters from the parent's cached data
+      Material->UpdateCachedExpressionData();
+      Materials.Add(Material);
+    }
 
-      ParentName = Line.Mid(Pos1 + 1, Pos2 - Pos1 - 1);
-      Name = Line.Mid(Pos2 + 1);
+    void Add(UMaterialInstance* Instance)
+    {
+      Instances.Add(Instance);
     }
 
-    while (++Idx < Lines.Num())
+    // Recompile the collected materials and wait for their shaders if REHelper.DeferMaterialCompile is 1.
+    // Materials created afterwards are collected for the next call.
+    void Compile()
     {
-      if (!Lines[Idx].StartsWith(TEXT(" ")))
+      if (Active != this || (!Materials.Num() && !Instances.Num()))
       {
-        break;
+        return;
       }
-      FString Trimmed = Lines[Idx].TrimStartAndEnd();
-      if (Trimmed == TEXT("TwoSided"))
+      ON_SCOPE_EXIT
       {
-        TwoSided = true;
-        continue;
+        Materials.Reset();
+        Instances.Reset();
+      };
+      const double StartTime = FPlatformTime::Seconds();
+      {
+        FScopedSlowTask Task((float)(Materials.Num() + Instances.Num()), NSLOCTEXT("REHelper", "CompileMaterials", "Compiling materials..."));
+        Task.MakeDialog();
+        // Render states are recreated once when the context ends
+        FMaterialUpdateContext UpdateContext;
+        for (UMaterial* Material : Materials)
+        {
+          Task.EnterProgressFrame(1.f);
+          UpdateContext.AddMaterial(Material);
+          Material->UpdateLightmassTextureTracking();
+          Material->ForceRecompileForRendering();
+        }
+        // Masters go first. Instances take static parameters from them.
+        for (UMaterialInstance* Instance : Instances)
+        {
+          Task.EnterProgressFrame(1.f);
+          UpdateContext.AddMaterialInstance(Instance);
+          Instance->PostEditChange();
+        }
       }
-
-      Pos1 = Trimmed.Find(VSEP);
-      if (Pos1 == INDEX_NONE)
+      const double SubmitTime = FPlatformTime::Seconds();
+      const int32 NumJobs = GShaderCompilingManager ? GShaderCompilingManager->GetNumRemainingJobs() : 0;
+      UE_LOG(LogTemp, Display, TEXT("RE Helper: Submitted %d materials and %d instances in %.2f s. %d shader jobs queued."), Materials.Num(), Instances.Num(), SubmitTime - StartTime, NumJobs);
+      if (!NumJobs || CVarDeferMaterialCompile.GetValueOnGameThread() != 1)
       {
-        break;
+        return;
       }
 
-      Pos2 = Trimmed.Find(VSEP, ESearchCase::IgnoreCase, ESearchDir::FromStart, Pos1 + 1);
-      if (Pos2 == INDEX_NONE)
+      FScopedSlowTask Task((float)NumJobs, NSLOCTEXT("REHelper", "CompileShaders", "Compiling shaders..."));
+      Task.MakeDialog(true);
+      int32 Done = 0;
+      while (GShaderCompilingManager->IsCompiling() && !Task.ShouldCancel())
       {
-        break;
+        GShaderCompilingManager->ProcessAsyncResults(true, false);
+        const int32 Remaining = GShaderCompilingManager->GetNumRemainingJobs();
+        const int32 NewDone = FMath::Clamp(NumJobs - Remaining, Done, NumJobs);
+        Task.EnterProgressFrame((float)(NewDone - Done), FText::FromString(FString::Printf(TEXT("Compiling shaders: %d left"), Remaining)));
+        Done = NewDone;
+        FPlatformProcess::Sleep(0.1f);
+      }
+      const double EndTime = FPlatformTime::Seconds();
+      if (GShaderCompilingManager->IsCompiling())
+      {
+        UE_LOG(LogTemp, Display, TEXT("RE Helper: Stopped waiting for shaders after %.2f s. %d jobs continue in the background."), EndTime - SubmitTime, GShaderCompilingManager->GetNumRemainingJobs());
+      }
+      else
+      {
+        UE_LOG(LogTemp, Display, TEXT("RE Helper: Compiled %d shader jobs in %.2f s. Material compile took %.2f s in total."), NumJobs, EndTime - SubmitTime, EndTime - StartTime);
       }
+    }
+
+  private:
+    TArray<UMaterial*> Materials;
+    TArray<UMaterialInstance*> Instances;
+    static FDeferredMaterialCompile* Active;
+  };
+
+  FDeferredMaterialCompile* FDeferredMaterialCompile::Active = nullptr;
 
-      FString Type = Trimmed.Mid(0, Pos1);
-      FString Parameter = Trimmed.Mid(Pos1 + 1, Pos2 - Pos1 - 1);
-      if (Type == TEXT("Texture"))
+  // Reads a text file block by block and hands out complete lines without line terminators.
+  // Memory use depends on the block size and the longest line, not on the file size.
+  class FDumpLineReader {
+  public:
+    bool Open(const FString& Path, FString& OutError)
+    {
+      if (!Stream.Open(Path, OutError))
       {
-        FString Value = Trimmed.Mid(Pos2 + 1);
-        TextureParameters.Add(Parameter, Value);
+        return false;
       }
-      else if (Type == TEXT("TextureA"))
+      // Keep the first block. ForEachLine starts with it.
+      Block.SetNumUninitialized((int32)FDumpStream::BlockSize);
+      BlockLen = Stream.Read((uint8*)Block.GetData(), Block.Num());
+      if (BlockLen < 0)
       {
-        FString Value = Trimmed.Mid(Pos2 + 1);
-        TextureParameters.Add(Parameter, Value);
-        TextureAParameters.Add(Parameter + TEXT("_Alpha"), Value + TEXT("_Alpha"));
+        OutError = Stream.GetError();
+        return false;
       }
-      else if (Type == TEXT("Scalar"))
+      const uint8* Bom = (const uint8*)Block.GetData();
+      if (BlockLen >= 2 && ((Bom[0] == 0xFF && Bom[1] == 0xFE) || (Bom[0] == 0xFE && Bom[1] == 0xFF)))
       {
-        FString Value = Trimmed.Mid(Pos2 + 1);
-        float V = FCString::Atof(*Value);
-        ScalarParameters.Add(Parameter, V);
+        bUtf16 = true;
       }
-      else if (Type == TEXT("Bool"))
+      else if (BlockLen >= 3 && Bom[0] == 0xEF && Bom[1] == 0xBB && Bom[2] == 0xBF)
       {
-        FString Value = Trimmed.Mid(Pos2 + 1);
-        bool V = FCString::ToBool(*Value);
-        BoolParameters.Add(Parameter, V);
+        BlockPos = 3;
       }
-      else if (Type == TEXT("Vector"))
+      return true;
+    }
+
+    // UTF-16 files can't be processed line by line. Use REDump::MapText for them.
+    bool IsUtf16() const
+    {
+      return bUtf16;
+    }
+
+    // Size of the file on disk. Compressed dumps report the compressed size.
+    int64 GetTotalSize() const
+    {
+      return Stream.GetRawSize();
+    }
+
+    int64 GetBytesRead() const
+    {
+      return Stream.GetRawBytesRead();
+    }
+
+    const FString& GetError() const
+    {
+      return Stream.GetError();
+    }
+
+    // Call Callback for every line. Return false from the Callback to stop reading. Returns false on IO error.
+    bool ForEachLine(TFunctionRef<bool(FAnsiStringView)> Callback)
+    {
+      TArray<ANSICHAR> Carry;
+      while (BlockLen > 0)
       {
-        Pos1 = Pos2;
-        Pos2 = Trimmed.Find(VSEP, ESearchCase::IgnoreCase, ESearchDir::FromStart, Pos1 + 1);
-        if (Pos2 == INDEX_NONE)
+        const ANSICHAR* Ptr = Block.GetData() + BlockPos;
+        const ANSICHAR* End = Block.GetData() + BlockLen;
+        while (Ptr < End)
         {
-          break;
+          const ANSICHAR* Eol = REScanner::FindChar(Ptr, End, '\n');
+          if (Eol == End)
+          {
+            // Incomplete line. Keep it until the next block arrives.
+            Carry.Append(Ptr, (int32)(End - Ptr));
+            break;
+          }
+          bool bContinue = true;
+          if (Carry.Num())
+          {
+            Carry.Append(Ptr, (int32)(Eol - Ptr));
+            bContinue = Callback(TrimEol(FAnsiStringView(Carry.GetData(), Carry.Num())));
+            Carry.Reset();
+          }
+          else
+          {
+            bContinue = Callback(TrimEol(FAnsiStringView(Ptr, (int32)(Eol - Ptr))));
+          }
+          if (!bContinue)
+          {
+            return true;
+          }
+          Ptr = Eol + 1;
         }
-        FString Value = Trimmed.Mid(Pos1 + 1, Pos2 - Pos1 - 1);
-        float R = FCString::Atof(*Value);
-        Pos1 = Pos2;
-        Pos2 = Trimmed.Find(VSEP, ESearchCase::IgnoreCase, ESearchDir::FromStart, Pos1 + 1);
-        if (Pos2 == INDEX_NONE)
+        BlockPos = 0;
+        BlockLen = Stream.Read((uint8*)Block.GetData(), Block.Num());
+        if (BlockLen < 0)
         {
-          break;
+          return false;
         }
-        Value = Trimmed.Mid(Pos1 + 1, Pos2 - Pos1 - 1);
-        float G = FCString::Atof(*Value);
-        Pos1 = Pos2;
-        Pos2 = Trimmed.Find(VSEP, ESearchCase::IgnoreCase, ESearchDir::FromStart, Pos1 + 1);
-        if (Pos2 == INDEX_NONE)
+      }
+      if (Carry.Num())
+      {
+        Callback(TrimEol(FAnsiStringView(Carry.GetData(), Carry.Num())));
+      }
+      return true;
+    }
+
+  private:
+    static FAnsiStringView TrimEol(FAnsiStringView Line)
+    {
+      return Line.EndsWith('\r') ? Line.LeftChop(1) : Line;
+    }
+
+    FDumpStream Stream;
+    TArray<ANSICHAR> Block;
+    int64 BlockLen = 0;
+    int64 BlockPos = 0;
+    bool bUtf16 = false;
+  };
+
+  // SoundWave paths of a cue
+  void GatherCueWaves(const REDumpCore::CueEntry& Cue, TArray<FString>& OutPaths)
+  {
+    for (const REDumpCore::CueNode& Node : Cue.Nodes)
+    {
+      for (const REDumpCore::CueProperty& Property : Node.Properties)
+      {
+        if (REDumpCore::Equals(Property.Key, "Sound"))
         {
-          break;
+          OutPaths.Add(ToFString(Property.Value));
         }
-        Value = Trimmed.Mid(Pos1 + 1, Pos2 - Pos1 - 1);
-        float B = FCString::Atof(*Value);
-        Value = Trimmed.Mid(Pos2 + 1);
-        float A = FCString::Atof(*Value);
-        VectorParameters.Add(Parameter, FLinearColor(R, G, B, A));
       }
     }
-    Idx--;
-    return true;
   }
-};
 
-struct RTexture {
-  FString Name;
-  FString Compression;
-  FString Source;
-  bool SRGB = false;
-  bool IsDXT = false;
+  template <typename T>
+  T* FindResource(const FString& Name)
+  {
+    return REResolver::Find<T>(Name);
+  }
 
-  bool ReadFromLine(const FString& Line)
+  // Sampler type that compiles against a texture with these settings
+  EMaterialSamplerType GetSamplerType(TextureCompressionSettings Compression, bool bSRGB)
   {
-    int32 Pos1 = Line.Find(VSEP);
-    if (Pos1 == INDEX_NONE)
+    switch (Compression)
     {
-      return false;
+    case TC_Normalmap:
+      return SAMPLERTYPE_Normal;
+    case TC_Grayscale:
+      return bSRGB ? SAMPLERTYPE_Grayscale : SAMPLERTYPE_LinearGrayscale;
+    case TC_Masks:
+      return SAMPLERTYPE_Masks;
+    default:
+      return bSRGB ? SAMPLERTYPE_Color : SAMPLERTYPE_LinearColor;
     }
-    Compression = Line.Mid(0, Pos1);
-    uint32 Pos2 = Line.Find(VSEP, ESearchCase::IgnoreCase, ESearchDir::FromStart, Pos1 + 1);
-    if (Pos2 == INDEX_NONE)
+  }
+
+  // Prefer Textures.txt over the texture's current settings. FixTextures may not have been applied yet.
+  void GetSamplerSettings(const FTextureMetadata* TextureMetadata, const FString& Path, UTexture* Texture, TextureCompressionSettings& OutCompression, bool& OutSRGB)
+  {
+    if (const RTexture* Entry = TextureMetadata ? TextureMetadata->Find(Path) : nullptr)
     {
-      return false;
+      REWorker::GetTextureSettings(*Entry, OutCompression, OutSRGB);
+      if (GetSamplerType(OutCompression, OutSRGB) != GetSamplerType(Texture->CompressionSettings, Texture->SRGB))
+      {
+        UE_LOG(LogTemp, Warning, TEXT("RE Helper: Textures.txt settings of \"%s\" don't match the texture yet. Materials using it won't compile until Fix Textures is applied."), *Path);
+      }
+      return;
     }
+    OutCompression = Texture->CompressionSettings;
+    OutSRGB = Texture->SRGB;
+  }
+
+  template <typename T>
+  T* CreateAsset(const FString& Name, UFactory* Factory)
+  {
+    return Cast<T>(REAssetBatch::CreateAsset(Name, T::StaticClass(), Factory));
+  }
+
+  // Link parents through a name index and order the materials so that every parent precedes its children.
+  // Level 0 are master materials, level N are instances of level N - 1. Materials with a missing ancestor or a cyclic
+  // parent chain are reported and left out. Returns false if any were.
+  bool SortMaterials(TArray<RMaterial>& Materials, TArray<RMaterial*>& OutOrder, int32& OutNumLevels)
+  {
+    const int32 Num = Materials.Num();
+    TMap<FString, int32> Index;
+    Index.Reserve(Num);
+    for (int32 Idx = 0; Idx < Num; ++Idx)
     {
-      FString Value = Line.Mid(Pos1 + 1, Pos2 - Pos1 - 1);
-      SRGB = FCString::ToBool(*Value);
+      // Duplicates resolve to the first entry
+      if (!Index.Contains(Materials[Idx].Name))
+      {
+        Index.Add(Materials[Idx].Name, Idx);
+      }
     }
-    Pos1 = Pos2;
-    Pos2 = Line.Find(VSEP, ESearchCase::IgnoreCase, ESearchDir::FromStart, Pos1 + 1);
-    if (Pos2 == INDEX_NONE)
+
+    const int32 MissingParent = -2;
+    bool bErrors = false;
+    TArray<int32> Parents;
+    Parents.Init(INDEX_NONE, Num);
+    // Children of material N are Children[ChildStart[N]..ChildStart[N + 1])
+    TArray<int32> ChildStart;
+    ChildStart.Init(0, Num + 1);
+    for (int32 Idx = 0; Idx < Num; ++Idx)
     {
-      return false;
+      RMaterial& Material = Materials[Idx];
+      Material.Parent = nullptr;
+      if (!Material.ParentName.Len())
+      {
+        continue;
+      }
+      if (const int32* Parent = Index.Find(Material.ParentName))
+      {
+        Parents[Idx] = *Parent;
+        ChildStart[*Parent + 1]++;
+      }
+      else
+      {
+        Parents[Idx] = MissingParent;
+        UE_LOG(LogTemp, Error, TEXT("RE Helper: Failed to find parent material \"%s\" for \"%s\". For some reasons Real Editor didn't include it in the dump file."), *Material.ParentName, *Material.Name);
+        bErrors = true;
+      }
     }
+    for (int32 Idx = 0; Idx < Num; ++Idx)
     {
-      FString Value = Line.Mid(Pos1 + 1, Pos2 - Pos1 - 1);
-      IsDXT = FCString::ToBool(*Value);
+      ChildStart[Idx + 1] += ChildStart[Idx];
     }
-    Pos1 = Pos2;
-    Pos2 = Line.Find(VSEP, ESearchCase::IgnoreCase, ESearchDir::FromStart, Pos1 + 1);
-    if (Pos2 == INDEX_NONE)
+    TArray<int32> Children;
+    Children.SetNumUninitialized(ChildStart[Num]);
     {
-      return false;
+      TArray<int32> Fill(ChildStart.GetData(), Num);
+      for (int32 Idx = 0; Idx < Num; ++Idx)
+      {
+        if (Parents[Idx] >= 0)
+        {
+          Children[Fill[Parents[Idx]]++] = Idx;
+        }
+      }
+    }
+
+    // Breadth first from the master materials. Every material has a single parent, so each one is visited once.
+    TArray<int32> Order;
+    Order.Reserve(Num);
+    for (int32 Idx = 0; Idx < Num; ++Idx)
+    {
+      if (Parents[Idx] == INDEX_NONE)
+      {
+        Order.Add(Idx);
+      }
+    }
+    OutNumLevels = 0;
+    for (int32 Begin = 0; Begin < Order.Num(); OutNumLevels++)
+    {
+      const int32 End = Order.Num();
+      for (int32 Pos = Begin; Pos < End; ++Pos)
+      {
+        const int32 Idx = Order[Pos];
+        for (int32 Child = ChildStart[Idx]; Child < ChildStart[Idx + 1]; ++Child)
+        {
+          Materials[Children[Child]].Parent = &Materials[Idx];
+          Order.Add(Children[Child]);
+        }
+      }
+      Begin = End;
+    }
+
+    if (Order.Num() < Num)
+    {
+      TBitArray<> Reached(false, Num);
+      for (int32 Idx : Order)
+      {
+        Reached[Idx] = true;
+      }
+      for (int32 Idx = 0; Idx < Num; ++Idx)
+      {
+        if (Reached[Idx] || Parents[Idx] == MissingParent)
+        {
+          continue;
+        }
+        // The chain ends at a missing parent or loops
+        int32 Ancestor = Parents[Idx];
+        for (int32 Step = 0; Ancestor >= 0 && Step < Num; ++Step)
+        {
+          Ancestor = Parents[Ancestor];
+        }
+        if (Ancestor == MissingParent)
+        {
+          UE_LOG(LogTemp, Error, TEXT("RE Helper: Skipped \"%s\". One of its ancestors is missing in the dump file."), *Materials[Idx].Name);
+        }
+        else
+        {
+          UE_LOG(LogTemp, Error, TEXT("RE Helper: Skipped \"%s\". Its parent chain is cyclic."), *Materials[Idx].Name);
+        }
+        bErrors = true;
+      }
+    }
+
+    OutOrder.Reset(Order.Num());
+    for (int32 Idx : Order)
+    {
+      OutOrder.Add(&Materials[Idx]);
     }
-    Name = Line.Mid(Pos1 + 1, Pos2 - Pos1 - 1);
-    Pos1 = Pos2;
-    Source = Line.Mid(Pos1 + 1);
-    return Name.Len() > 0 && Source.Len() > 0;
+    return !bErrors;
   }
-};
+}
 
-TArray<UObject*> REWorker::ImportMaterials(const FString& Path, FString& OutError)
+TArray<UObject*> REWorker::ImportMaterials(const FString& Path, FString& OutError, const FString& TexturesPath)
 {
+  // Saves everything the import created or modified when it returns
+  FScopedPackageSave PackageSave;
   TArray<UObject*> Result;
-  TArray<FString> Lines;
-  FFileHelper::LoadFileToStringArray(Lines, *Path);
-  if (!Lines.Num())
+  TArray<RMaterial> Materials;
+  bool bParseErrors = false;
+  if (!REDump::LoadMaterials(Path, Materials, bParseErrors))
   {
     OutError = TEXT("The file appears to be empty!");
     return Result;
   }
-
-  TArray<RMaterial> Materials;
-  for (int32 Idx = 0; Idx < Lines.Num(); ++Idx)
+  if (bParseErrors)
   {
-    if (Lines[Idx].StartsWith(TEXT(" ")))
-    {
-      // If RMaterial::ReadFromArray failed Idx may not be correct. Find next entry
-      continue;
-    }
-
-    RMaterial Material;
-    int32 StartIdx = Idx;
-    if (!Material.ReadFromArray(Lines, Idx))
-    {
-      UE_LOG(LogTemp, Error, TEXT("RE Helper: Failed to parse material entry at line %d"), StartIdx + 1);
-      OutError = TEXT("Some errors occured. See the Output Log for details.");
-      continue;
-    }
-    Materials.Add(Material);
+    OutError = TEXT("Some errors occured. See the Output Log for details.");
   }
 
   if (!Materials.Num())
@@ -307,98 +606,207 @@ TArray<UObject*> REWorker::ImportMaterials(const FString& Path, FString& OutErro
     return Result;
   }
 
-  FScopedSlowTask Task((float)Materials.Num(), NSLOCTEXT("REHelper", "ImportMaterials", "Importing materials..."));
-  Task.MakeDialog();
+  // Validate references before anything is created
+  FScopedResolverCache ResolverCache;
+  if (!REValidator::Preflight(Path, Materials))
+  {
+    OutError = TEXT("Import cancelled. See the Output Log for the validation report.");
+    return Result;
+  }
+
+  FTextureMetadata TextureMetadata;
+  if (TexturesPath.Len() && !TextureMetadata.Load(TexturesPath))
+  {
+    UE_LOG(LogTemp, Warning, TEXT("RE Helper: Failed to load \"%s\". Sampler types will follow the current texture settings."), *TexturesPath);
+  }
+  else if (TexturesPath.Len())
+  {
+    UE_LOG(LogTemp, Display, TEXT("RE Helper: Sampler types follow \"%s\""), *TexturesPath);
+  }
+
+  TArray<RMaterial*> Order;
+  int32 NumLevels = 0;
+  if (!SortMaterials(Materials, Order, NumLevels))
+  {
+    OutError = TEXT("Some errors occurred. See the Output Log for details.");
+  }
+  UE_LOG(LogTemp, Display, TEXT("RE Helper: Importing %d materials in %d levels"), Order.Num(), NumLevels);
 
-  // Link parents and create master materials
-  UMaterialFactoryNew* MatFactory = NewObject<UMaterialFactoryNew>();
-  for (RMaterial& Material : Materials)
+  FScopedSlowTask Task((float)Order.Num(), NSLOCTEXT("REHelper", "ImportMaterials", "Importing materials..."));
+  Task.MakeDialog();
   {
-    if (!Material.ParentName.Len())
+    TArray<FString> Paths;
+    for (const RMaterial* Material : Order)
     {
-      Task.EnterProgressFrame(1.f, FText::FromString(TEXT("Importing: ") + Material.Name));
-      // Material is a MasterMaterial. Check if it does not exist and create it.
-      UMaterial* Asset = FindResource<UMaterial>(Material.Name);
-      if (!Asset)
+      Paths.Add(Material->Name);
+      for (const TPair<FName, FName>& P : Material->TextureParameters)
       {
-        Asset = CreateAsset<UMaterial>(Material.Name, MatFactory);
-        if (Asset)
-        {
-          Result.Add(Cast<UObject>(Asset));
-          bool Error = false;
-          SetupMasterMaterial(Asset, &Material, Error);
-          if (Error && !OutError.Len())
-          {
-            OutError = TEXT("Some errors occured. See the Output Log for details.");
-          }
-        }
-        else
-        {
-          UE_LOG(LogTemp, Error, TEXT("RE Helper: Failed to find/create Master Material \"%s\""), *Material.Name);
-          OutError = TEXT("Some errors occured. See the Output Log for details.");
-        }
+        Paths.Add(P.Value.ToString());
+      }
+      for (const TPair<FName, FName>& P : Material->TextureAParameters)
+      {
+        Paths.Add(P.Value.ToString());
       }
-      Material.UnrealMaterial = Asset;
-      continue;
     }
-
-    Material.Parent = Materials.FindByPredicate([&](const RMaterial& a) {
-      return a.Name == Material.ParentName;
-    });
-
-    if (!Material.Parent)
+    // Preloaded assets stay loaded until the end and would defeat the memory budget of a batched import
+    if (REImportBatch::IsEnabled())
     {
-      UE_LOG(LogTemp, Error, TEXT("RE Helper: Failed to find parent material \"%s\" for \"%s\". For some reasons Real Editor didn't include it in the dump file."), *Material.ParentName, *Material.Name);
-      OutError = TEXT("Some errors occurred. See the Output Log for details.");
+      REResolver::PreIndex(Paths);
+    }
+    else
+    {
+      REResolver::Preload(Paths);
     }
   }
 
-  // Create Material Instances. Skip Mater Materials.
-  bool AnyMiErrors = false;
-  UMaterialInstanceConstantFactoryNew* MiFactory = NewObject<UMaterialInstanceConstantFactoryNew>();
-  for (RMaterial& Material : Materials)
+  // Parents precede their children, so a single pass creates master materials first and then instances level by level
+  FScopedImportBatch ImportBatch;
+  FScopedAssetBatch AssetBatch;
+  FDeferredMaterialCompile DeferredCompile;
+  // Rooted, batched imports collect garbage in between
+  TStrongObjectPtr<UMaterialFactoryNew> MatFactory(NewObject<UMaterialFactoryNew>());
+  TStrongObjectPtr<UMaterialInstanceConstantFactoryNew> MiFactory(NewObject<UMaterialInstanceConstantFactoryNew>());
+  // Result loses the batches that were unloaded
+  TArray<FSoftObjectPath> PrewarmPaths;
+  for (RMaterial* Material : Order)
   {
-    if (!Material.ParentName.Len() || !Material.Parent)
+    Task.EnterProgressFrame(1.f, FText::FromString(TEXT("Importing: ") + Material->Name));
+    bool Error = false;
+    const TArray<UObject*> Created = ImportMaterial(Material, MatFactory.Get(), MiFactory.Get(), Error, TextureMetadata.Textures.Num() ? &TextureMetadata : nullptr);
+    for (UObject* Asset : Created)
     {
-      // Master Material
-      continue;
+      if (Asset && Asset->IsA<UMaterialInterface>())
+      {
+        PrewarmPaths.Add(Asset);
+      }
+    }
+    Result.Append(Created);
+    if (Error && !OutError.Len())
+    {
+      OutError = TEXT("Some errors occurred. See the Output Log for details.");
     }
-    Task.EnterProgressFrame(1.f, FText::FromString(TEXT("Importing: ") + Material.Name));
-    TArray<UObject*> Tmp = CreateMaterialInstance(&Material, MiFactory, AnyMiErrors);
-    if (Tmp.Num())
+    if (REImportBatch::ShouldFlush())
     {
-      Result.Insert(Tmp, Result.Num() - 1);
+      DeferredCompile.Compile();
+      // Records point at objects that are about to be unloaded. Instances look their parents up again,
+      // and the batch unloads the reloaded parents together with its own assets.
+      for (RMaterial& Record : Materials)
+      {
+        Record.UnrealMaterial = nullptr;
+      }
+      REImportBatch::Flush(Result);
     }
   }
-  if (AnyMiErrors)
+  DeferredCompile.Compile();
+  REShaderPrewarm::OnMaterialsImported(PrewarmPaths);
+  return Result;
+}
+
+TArray<UObject*> REWorker::ImportMaterial(RMaterial* Material, UFactory* MatFactory, UFactory* MiFactory, bool& Error, const FTextureMetadata* TextureMetadata)
+{
+  if (!Material->ParentName.Len())
   {
-    OutError = TEXT("Some errors occurred. See the Output Log for details.");
+    TArray<UObject*> Result;
+    if (UObject* Asset = CreateMasterMaterial(Material, MatFactory, Error, TextureMetadata))
+    {
+      Result.Add(Asset);
+    }
+    return Result;
   }
-  return Result;
+  return CreateMaterialInstance(Material, MiFactory, Error);
+}
+
+int32 REWorker::GetT3DActorsPerChunk()
+{
+  return CVarT3DActorsPerChunk.GetValueOnGameThread();
+}
+
+void REWorker::GetTextureSettings(const RTexture& Texture, TextureCompressionSettings& OutCompression, bool& OutSRGB)
+{
+  if (Texture.Compression == TEXT("TC_Grayscale"))
+  {
+    OutCompression = TC_Grayscale;
+    OutSRGB = false;
+  }
+  else if (Texture.Compression.StartsWith(TEXT("TC_Normalmap")))
+  {
+    OutCompression = TC_Normalmap;
+    OutSRGB = false;
+  }
+  else if (!Texture.IsDXT)
+  {
+    OutCompression = TC_Masks;
+    OutSRGB = false;
+  }
+  else
+  {
+    OutCompression = TC_Default;
+    OutSRGB = Texture.SRGB;
+  }
+}
+
+bool FTextureMetadata::Load(const FString& Path)
+{
+  bool bParseErrors = false;
+  Textures.Reset();
+  ByPath.Reset();
+  if (!REDump::LoadTextures(Path, Textures, bParseErrors))
+  {
+    return false;
+  }
+  ByPath.Reserve(Textures.Num());
+  for (int32 Idx = 0; Idx < Textures.Num(); ++Idx)
+  {
+    ByPath.Add(REResolver::NormalizePath(Textures[Idx].Name), Idx);
+  }
+  return Textures.Num() > 0;
+}
+
+const RTexture* FTextureMetadata::Find(const FString& TexturePath) const
+{
+  const int32* Idx = ByPath.Find(REResolver::NormalizePath(TexturePath));
+  return Idx ? &Textures[*Idx] : nullptr;
 }
 
 int32 REWorker::AssignDefaultMaterials(const FString& Path, FString& OutError)
 {
-  TArray<FString> Items;
-  FFileHelper::LoadFileToStringArray(Items, *Path);
-  if (!Items.Num())
+  FScopedPackageSave PackageSave;
+  TArray<RDefaultMaterials> Items;
+  bool bParseErrors = false;
+  if (!REDump::LoadDefaultMaterials(Path, Items, bParseErrors) || !Items.Num())
   {
     OutError = TEXT("The file appears to be empty!");
     return -1;
   }
 
+  FScopedResolverCache ResolverCache;
+  if (!REValidator::Preflight(Path, Items))
+  {
+    OutError = TEXT("Import cancelled. See the Output Log for the validation report.");
+    return -1;
+  }
+
   FScopedSlowTask Task((float)Items.Num(), NSLOCTEXT("REHelper", "AssigningMaterials", "Assigning defaults..."));
   Task.MakeDialog();
+  {
+    TArray<FString> Paths;
+    for (const RDefaultMaterials& Item : Items)
+    {
+      Paths.Add(Item.Name);
+      Paths.Append(Item.Materials);
+    }
+    REResolver::Preload(Paths);
+  }
 
+  // Slot edits of the whole file are applied first and the meshes are rebuilt together
+  const bool bBatchBuild = CVarBatchMeshBuild.GetValueOnGameThread() != 0;
+  TArray<UStaticMesh*> StaticMeshes;
+  TArray<USkeletalMesh*> SkeletalMeshes;
   int32 Result = 0;
-  for (int32 Idx = 0; Idx < Items.Num(); ++Idx)
+  for (const RDefaultMaterials& Item : Items)
   {
     Task.EnterProgressFrame(1.f);
-    if (Items[Idx].StartsWith(TEXT(" ")))
-    {
-      continue;
-    }
-    FString Name = TEXT("/") + Items[Idx];
+    FString Name = TEXT("/") + Item.Name;
     UObject* Asset = FindResource<UObject>(*Name);
 
     if (!Asset)
@@ -410,13 +818,8 @@ int32 REWorker::AssignDefaultMaterials(const FString& Path, FString& OutError)
 
     TArray<UMaterialInterface*> Defaults;
     TArray<UMaterialInterface*> Leafs;
-    while (++Idx < Items.Num())
+    for (const FString& MaterialName : Item.Materials)
     {
-      if (!Items[Idx].StartsWith(TEXT(" ")))
-      {
-        break;
-      }
-      FString MaterialName = Items[Idx].TrimStartAndEnd();
       if (MaterialName == TEXT("None"))
       {
         Defaults.Add(nullptr);
@@ -437,7 +840,6 @@ int32 REWorker::AssignDefaultMaterials(const FString& Path, FString& OutError)
         Defaults.Add(Material);
       }
     }
-    Idx--;
 
     bool AnyChanges = false;
     if (UStaticMesh* StaticMesh = Cast<UStaticMesh>(Asset))
@@ -520,27 +922,53 @@ int32 REWorker::AssignDefaultMaterials(const FString& Path, FString& OutError)
     if (AnyChanges)
     {
       Result++;
-      Asset->PostEditChange();
+      if (!bBatchBuild)
+      {
+        Asset->PostEditChange();
+      }
+      else if (UStaticMesh* StaticMesh = Cast<UStaticMesh>(Asset))
+      {
+        StaticMeshes.Add(StaticMesh);
+      }
+      else
+      {
+        SkeletalMeshes.Add(CastChecked<USkeletalMesh>(Asset));
+      }
     }
   }
-  return Result;
-}
-
-int32 REWorker::FixTextures(const FString& Path, FString& OutError)
-{
-  TArray<FString> Lines;
-  FFileHelper::LoadFileToStringArray(Lines, *Path);
-  
 
-  TArray<RTexture> Textures;
-  for (const FString& Line : Lines)
+  if (StaticMeshes.Num() || SkeletalMeshes.Num())
   {
-    RTexture Texture;
-    if (Texture.ReadFromLine(Line))
+    const double StartTime = FPlatformTime::Seconds();
+    FScopedSlowTask BuildTask((float)(StaticMeshes.Num() + SkeletalMeshes.Num()), NSLOCTEXT("REHelper", "RebuildingMeshes", "Rebuilding meshes..."));
+    BuildTask.MakeDialog();
+    // Builds the render data in parallel and recreates render states of the components once
+    UStaticMesh::BatchBuild(StaticMeshes, true, [&BuildTask](UStaticMesh*) {
+      BuildTask.EnterProgressFrame(1.f);
+      return true;
+    });
+    for (UStaticMesh* StaticMesh : StaticMeshes)
     {
-      Textures.Add(Texture);
+      StaticMesh->MarkPackageDirty();
     }
+    // There's no batch build for skeletal meshes in 4.27
+    for (USkeletalMesh* SkeletalMesh : SkeletalMeshes)
+    {
+      BuildTask.EnterProgressFrame(1.f);
+      SkeletalMesh->PostEditChange();
+      SkeletalMesh->MarkPackageDirty();
+    }
+    UE_LOG(LogTemp, Display, TEXT("RE Helper: Rebuilt %d static and %d skeletal meshes in %.2f s"), StaticMeshes.Num(), SkeletalMeshes.Num(), FPlatformTime::Seconds() - StartTime);
   }
+  return Result;
+}
+
+int32 REWorker::FixTextures(const FString& Path, FString& OutError, FString* OutStats)
+{
+  FScopedPackageSave PackageSave;
+  TArray<RTexture> Textures;
+  bool bParseErrors = false;
+  REDump::LoadTextures(Path, Textures, bParseErrors);
 
   if (!Textures.Num())
   {
@@ -548,95 +976,119 @@ int32 REWorker::FixTextures(const FString& Path, FString& OutError)
     return -1;
   }
 
-  FScopedSlowTask Task((float)Textures.Num(), NSLOCTEXT("REHelper", "FixTextures", "Fixing textures..."));
+  FScopedResolverCache ResolverCache;
+  if (!REValidator::Preflight(Path, Textures))
+  {
+    OutError = TEXT("Import cancelled. See the Output Log for the validation report.");
+    return -1;
+  }
+
+  FScopedSlowTask Task((float)Textures.Num() * 2.f, NSLOCTEXT("REHelper", "FixTextures", "Fixing textures..."));
   Task.MakeDialog();
 
+  // Apply the settings first. Only the textures that changed are rebuilt.
+  const bool bParallel = CVarParallelTextures.GetValueOnGameThread() != 0;
+  const double StartTime = FPlatformTime::Seconds();
+  TArray<UTexture*> Changed;
+  int64 SourceBytes = 0;
+  int32 NumRebuilt = 0;
   int32 Result = 0;
   for (const RTexture& Texture : Textures)
   {
+    Task.EnterProgressFrame(1.f);
     // TODO: import the asset?
     if (UTexture* Asset = FindResource<UTexture>(Texture.Name))
     {
-      if (Texture.Compression == TEXT("TC_Grayscale"))
-      {
-        Asset->CompressionSettings = TC_Grayscale;
-        Asset->SRGB = false;
-      }
-      else if (Texture.Compression.StartsWith(TEXT("TC_Normalmap")))
-      {
-        Asset->CompressionSettings = TC_Normalmap;
-        Asset->SRGB = false;
-      }
-      else if (!Texture.IsDXT)
+      Result++;
+      TextureCompressionSettings Compression = TC_Default;
+      bool bSRGB = false;
+      GetTextureSettings(Texture, Compression, bSRGB);
+      if (Asset->CompressionSettings == Compression && (bool)Asset->SRGB == bSRGB)
       {
-        Asset->CompressionSettings = TC_Masks;
-        Asset->SRGB = false;
+        continue;
       }
-      else
+      Asset->CompressionSettings = Compression;
+      Asset->SRGB = bSRGB;
+      SourceBytes += Asset->Source.CalcMipSize(0);
+      NumRebuilt++;
+      if (bParallel)
       {
-        Asset->CompressionSettings = TC_Default;
-        Asset->SRGB = Texture.SRGB;
+        Changed.Add(Asset);
+        continue;
       }
       Asset->PostEditChange();
       Asset->GetPackage()->SetDirtyFlag(true);
       FAssetRegistryModule::AssetCreated(Asset);
-      Task.EnterProgressFrame(1.f);
-      Result++;
-      continue;
     }
   }
+  Task.EnterProgressFrame((float)(Textures.Num() - Changed.Num()));
+  if (Changed.Num())
+  {
+    RebuildTextures(Changed, Task);
+  }
+
+  const double Seconds = FMath::Max(FPlatformTime::Seconds() - StartTime, 0.001);
+  const FString Stats = FString::Printf(TEXT("Rebuilt %d of %d textures in %.1f s (%.1f textures/s, %.1f MB/s of source data)."), NumRebuilt, Result, Seconds, NumRebuilt / Seconds, SourceBytes / (1024. * 1024.) / Seconds);
+  UE_LOG(LogTemp, Display, TEXT("RE Helper: %s"), *Stats);
+  if (OutStats)
+  {
+    *OutStats = Stats;
+  }
   return Result;
 }
 
 int32 REWorker::FixSpeedTrees(const FString& Path, ULevel* Level, FString& OutError)
 {
-  TArray<FString> Lines;
-  FFileHelper::LoadFileToStringArray(Lines, *Path);
-  if (!Lines.Num())
+  FScopedPackageSave PackageSave;
+  TArray<RSpeedTreeOverride> Entries;
+  bool bParseErrors = false;
+  if (!REDump::LoadSpeedTreeOverrides(Path, Entries, bParseErrors))
   {
     OutError = TEXT("The file appears to be empty!");
     return -1;
   }
 
+  FScopedResolverCache ResolverCache;
+  if (!REValidator::Preflight(Path, Entries))
+  {
+    OutError = TEXT("Import cancelled. See the Output Log for the validation report.");
+    return -1;
+  }
+
   int32 Result = 0;
-  TMap<FString, TMap<FString, UMaterialInterface*>> MaterialMap;
-  for (int32 Idx = 0; Idx < Lines.Num(); ++Idx)
   {
-    if (Lines[Idx].StartsWith(TEXT(" ")))
-    {
-      continue;
-    }
-    FString Name = Lines[Idx];
-    MaterialMap.Add(Name, TMap<FString, UMaterialInterface*>());
-    while (++Idx < Lines.Num())
+    TArray<FString> Paths;
+    for (const RSpeedTreeOverride& Entry : Entries)
     {
-      if (!Lines[Idx].StartsWith(TEXT(" ")))
-      {
-        break;
-      }
-      FString Trimmed = Lines[Idx].TrimStartAndEnd();
-      int32 Pos = Trimmed.Find(VSEP);
-      if (Pos == INDEX_NONE)
+      for (const RMaterialOverride& Override : Entry.Overrides)
       {
-        continue;
+        Paths.Add(Override.Material);
       }
-      FString MaterialName = Trimmed.Mid(Pos + 1);
-      if (MaterialName != TEXT("None"))
+    }
+    REResolver::Preload(Paths);
+  }
+  TMap<FString, TMap<FString, UMaterialInterface*>> MaterialMap;
+  for (const RSpeedTreeOverride& Entry : Entries)
+  {
+    const FString& Name = Entry.ActorName;
+    TMap<FString, UMaterialInterface*>& ActorMaterials = MaterialMap.Add(Name, TMap<FString, UMaterialInterface*>());
+    for (const RMaterialOverride& Override : Entry.Overrides)
+    {
+      if (Override.Material != TEXT("None"))
       {
-        UMaterialInterface* Material = FindResource<UMaterialInterface>(MaterialName);
-        MaterialMap[Name].Add(Trimmed.Mid(0, Pos), Material);
+        UMaterialInterface* Material = FindResource<UMaterialInterface>(Override.Material);
+        ActorMaterials.Add(Override.Slot, Material);
         if (!Material)
         {
-          UE_LOG(LogTemp, Error, TEXT("RE Helper: Failed to find Material \"%s\" for actor \"%s\""), *MaterialName, *Name);
+          UE_LOG(LogTemp, Error, TEXT("RE Helper: Failed to find Material \"%s\" for actor \"%s\""), *Override.Material, *Name);
           OutError = TEXT("Some errors occured. See the Output Log for details.");
         }
       }
       else
       {
-        MaterialMap[Name].Add(Trimmed.Mid(0, Pos), nullptr);
+        ActorMaterials.Add(Override.Slot, nullptr);
       }
     }
-    Idx--;
   }
 
   if (!MaterialMap.Num())
@@ -674,10 +1126,125 @@ int32 REWorker::FixSpeedTrees(const FString& Path, ULevel* Level, FString& OutEr
       }
     }
   }
-  return Result;
+  return Result;
+}
+
+int32 REWorker::ImportActors(const FString& Path, UWorld* World, FString& OutError)
+{
+  FScopedPackageSave PackageSave;
+  FDumpLineReader Reader;
+  if (!Reader.Open(Path, OutError))
+  {
+    UE_LOG(LogTemp, Error, TEXT("RE Helper: %s"), *OutError);
+    return -1;
+  }
+
+  FScopedResolverCache ResolverCache;
+  if (!CVarStreamT3D.GetValueOnGameThread() || Reader.IsUtf16())
+  {
+    FString Input;
+    FDumpText Text;
+    if (REDump::MapText(Path, Text))
+    {
+      if (!Reader.IsUtf16())
+      {
+        // Meshes and materials of all actors
+        TSet<FString> Paths;
+        FT3DChunkImporter::GatherReferences(FAnsiStringView((const ANSICHAR*)Text.GetData(), (int32)Text.Num()), Paths);
+        REResolver::Preload(Paths.Array());
+      }
+      FFileHelper::BufferToString(Input, Text.GetData(), (int32)Text.Num());
+    }
+    if (!Input.StartsWith(TEXT("BEGIN MAP")))
+    {
+      OutError = TEXT("The file is not a valid T3D file!");
+      return -1;
+    }
+    FScopedSlowTask Task(.0f, NSLOCTEXT("REHelper", "ImportingActors", "Importing actors..."));
+    Task.MakeDialog();
+    GEditor->edactPasteSelected(World, false, false, true, &Input);
+    GEditor->SelectNone(false, true, false);
+
+    int32 Result = 0;
+    for (int32 Pos = Input.Find(TEXT("BEGIN ACTOR")); Pos != INDEX_NONE; Pos = Input.Find(TEXT("BEGIN ACTOR"), ESearchCase::IgnoreCase, ESearchDir::FromStart, Pos + 1))
+    {
+      Result++;
+    }
+    return Result;
+  }
+
+  FScopedSlowTask Task((float)Reader.GetTotalSize(), NSLOCTEXT("REHelper", "ImportingActors", "Importing actors..."));
+  Task.MakeDialog(true);
+
+  FT3DChunkImporter Importer(World, GetT3DActorsPerChunk());
+  bool bCancelled = false;
+  int64 ReportedBytes = 0;
+  const bool bReadOk = Reader.ForEachLine([&](FAnsiStringView Line) {
+    const int32 NumActors = Importer.GetNumActors();
+    if (!Importer.AddLine(Line))
+    {
+      return false;
+    }
+    if (Importer.GetNumActors() != NumActors)
+    {
+      // A chunk was pasted
+      const int64 BytesRead = Reader.GetBytesRead();
+      Task.EnterProgressFrame((float)(BytesRead - ReportedBytes), FText::FromString(FString::Printf(TEXT("Importing actors: %d"), Importer.GetNumActors())));
+      ReportedBytes = BytesRead;
+      if (Task.ShouldCancel())
+      {
+        bCancelled = true;
+        return false;
+      }
+    }
+    return true;
+  });
+
+  if (!Importer.IsValid())
+  {
+    OutError = TEXT("The file is not a valid T3D file!");
+    return -1;
+  }
+
+  if (!bCancelled)
+  {
+    Importer.Flush();
+  }
+
+  if (!bReadOk)
+  {
+    UE_LOG(LogTemp, Error, TEXT("RE Helper: Failed to read \"%s\" at offset %lld. %s"), *Path, Reader.GetBytesRead(), *Reader.GetError());
+    OutError = TEXT("Failed to read the whole file. Some actors were not imported.");
+  }
+  else if (bCancelled)
+  {
+    OutError = TEXT("Import was cancelled. Some actors were not imported.");
+  }
+  return Importer.GetNumActors();
+}
+
+UObject* REWorker::CreateMasterMaterial(RMaterial* RealMaterial, UFactory* MatFactory, bool& Error, const FTextureMetadata* TextureMetadata)
+{
+  // Check if the Master Material does not exist and create it
+  UMaterial* Asset = FindResource<UMaterial>(RealMaterial->Name);
+  if (Asset)
+  {
+    RealMaterial->UnrealMaterial = Asset;
+    return nullptr;
+  }
+  Asset = CreateAsset<UMaterial>(RealMaterial->Name, MatFactory);
+  RealMaterial->UnrealMaterial = Asset;
+  if (!Asset)
+  {
+    UE_LOG(LogTemp, Error, TEXT("RE Helper: Failed to find/create Master Material \"%s\""), *RealMaterial->Name);
+    Error = true;
+    return nullptr;
+  }
+  SetupMasterMaterial(Asset, RealMaterial, Error, TextureMetadata);
+  return Asset;
 }
 
-void REWorker::SetupMasterMaterial(UMaterial* UnrealMaterial, RMaterial* RealMaterial, bool& Error)
+void REWorker::SetupMasterMaterial(UMaterial* UnrealMaterial, RMaterial* RealMaterial, bool& Error, const FTextureMetadata* TextureMetadata)
 {
   if (!UnrealMaterial)
   {
@@ -703,15 +1270,15 @@ void REWorker::SetupMasterMaterial(UMaterial* UnrealMaterial, RMaterial* RealMat
 
   FExpressionInput* Input = nullptr;
 
-  FString SkipDiffuseParameter;
+  FName SkipDiffuseParameter;
   for (const auto& P : RealMaterial->TextureParameters)
   {
     if (P.Key == TEXT("DiffuseMap"))
     {
       UTexture* Texture = nullptr;
-      if (P.Value.Len() && P.Value != TEXT("None"))
+      if (!P.Value.IsNone())
       {
-        Texture = FindResource<UTexture>(P.Value);
+        Texture = FindResource<UTexture>(P.Value.ToString());
       }
       if (!Texture)
       {
@@ -738,16 +1305,12 @@ void REWorker::SetupMasterMaterial(UMaterial* UnrealMaterial, RMaterial* RealMat
 
       Param->MaterialExpressionEditorX = -PosX;
       Param->MaterialExpressionEditorY = GetPosY(324);
-      Param->ParameterName = *P.Key;
+      Param->ParameterName = P.Key;
       Param->Texture = Texture;
-      if (Texture->IsNormalMap())
-      {
-        Param->SamplerType = SAMPLERTYPE_Normal;
-      }
-      else if (Texture->CompressionSettings == TC_Grayscale)
-      {
-        Param->SamplerType = SAMPLERTYPE_Grayscale;
-      }
+      TextureCompressionSettings Compression = TC_Default;
+      bool bSRGB = true;
+      GetSamplerSettings(TextureMetadata, P.Value.ToString(), Texture, Compression, bSRGB);
+      Param->SamplerType = GetSamplerType(Compression, bSRGB);
       Root->A.Expression = Param;
 
       UMaterialExpressionMultiply* Mul = NewObject<UMaterialExpressionMultiply>(UnrealMaterial);
@@ -785,21 +1348,21 @@ void REWorker::SetupMasterMaterial(UMaterial* UnrealMaterial, RMaterial* RealMat
 
   for (const auto& P : RealMaterial->TextureParameters)
   {
-    if (SkipDiffuseParameter.Len() && P.Key == SkipDiffuseParameter)
+    if (!SkipDiffuseParameter.IsNone() && P.Key == SkipDiffuseParameter)
     {
       continue;
     }
 
     UTexture* Texture = nullptr;
-    if (P.Value.Len() && P.Value != TEXT("None"))
+    if (!P.Value.IsNone())
     {
-      Texture = FindResource<UTexture>(P.Value);
+      Texture = FindResource<UTexture>(P.Value.ToString());
     }
 
     if (!Texture)
     {
       Error = true;
-      UE_LOG(LogTemp, Error, TEXT("RE Helper: Failed to create a Texture Parameter \"%s\" for Material \"%s\""), *P.Key, *RealMaterial->Name);
+      UE_LOG(LogTemp, Error, TEXT("RE Helper: Failed to create a Texture Parameter \"%s\" for Material \"%s\""), *P.Key.ToString(), *RealMaterial->Name);
       continue;
     }
 
@@ -830,28 +1393,16 @@ void REWorker::SetupMasterMaterial(UMaterial* UnrealMaterial, RMaterial* RealMat
 
     Param->MaterialExpressionEditorX = -PosX;
     Param->MaterialExpressionEditorY = GetPosY(324);
-    Param->ParameterName = *P.Key;
+    Param->ParameterName = P.Key;
     
     Input->Expression = Param;
     Input = &Add->B;
     
     Param->Texture = Texture;
-    if (Texture->IsNormalMap())
-    {
-      Param->SamplerType = SAMPLERTYPE_Normal;
-    }
-    else if (Texture->CompressionSettings == TC_Grayscale)
-    {
-      Param->SamplerType = Texture->SRGB ? SAMPLERTYPE_Grayscale : SAMPLERTYPE_LinearGrayscale;
-    }
-    else if (Texture->CompressionSettings == TC_Masks)
-    {
-      Param->SamplerType = SAMPLERTYPE_Masks;
-    }
-    else
-    {
-      Param->SamplerType = Texture->SRGB ? SAMPLERTYPE_Color : SAMPLERTYPE_LinearColor;
-    }
+    TextureCompressionSettings Compression = TC_Default;
+    bool bSRGB = true;
+    GetSamplerSettings(TextureMetadata, P.Value.ToString(), Texture, Compression, bSRGB);
+    Param->SamplerType = GetSamplerType(Compression, bSRGB);
   }
 
   if (ReflectionVector)
@@ -863,15 +1414,15 @@ void REWorker::SetupMasterMaterial(UMaterial* UnrealMaterial, RMaterial* RealMat
   for (const auto& P : RealMaterial->TextureAParameters)
   {
     UTexture* Texture = nullptr;
-    if (P.Value.Len() && P.Value != TEXT("None"))
+    if (!P.Value.IsNone())
     {
-      Texture = FindResource<UTexture>(P.Value);
+      Texture = FindResource<UTexture>(P.Value.ToString());
     }
 
     if (!Texture)
     {
       Error = true;
-      UE_LOG(LogTemp, Error, TEXT("RE Helper: Failed to create a Texture Parameter \"%s\" for Material \"%s\""), *P.Key, *RealMaterial->Name);
+      UE_LOG(LogTemp, Error, TEXT("RE Helper: Failed to create a Texture Parameter \"%s\" for Material \"%s\""), *P.Key.ToString(), *RealMaterial->Name);
       continue;
     }
 
@@ -888,13 +1439,16 @@ void REWorker::SetupMasterMaterial(UMaterial* UnrealMaterial, RMaterial* RealMat
 
     Param->MaterialExpressionEditorX = -PosX;
     Param->MaterialExpressionEditorY = GetPosY(324);
-    Param->ParameterName = *P.Key;
+    Param->ParameterName = P.Key;
 
     Input->Expression = Param;
     Input = &Add->B;
 
     Param->Texture = Texture;
-    Param->SamplerType = Texture->SRGB ? SAMPLERTYPE_Grayscale : SAMPLERTYPE_LinearGrayscale;
+    TextureCompressionSettings Compression = TC_Default;
+    bool bSRGB = true;
+    GetSamplerSettings(TextureMetadata, P.Value.ToString(), Texture, Compression, bSRGB);
+    Param->SamplerType = bSRGB ? SAMPLERTYPE_Grayscale : SAMPLERTYPE_LinearGrayscale;
   }
 
   for (const auto& P : RealMaterial->ScalarParameters)
@@ -910,7 +1464,7 @@ void REWorker::SetupMasterMaterial(UMaterial* UnrealMaterial, RMaterial* RealMat
     UnrealMaterial->Expressions.Add(Param);
     Param->MaterialExpressionEditorX = -PosX;
     Param->MaterialExpressionEditorY = GetPosY(160);
-    Param->ParameterName = *P.Key;
+    Param->ParameterName = P.Key;
     Param->DefaultValue = P.Value;
     Input->Expression = Param;
     Input = &Add->B;
@@ -928,7 +1482,7 @@ void REWorker::SetupMasterMaterial(UMaterial* UnrealMaterial, RMaterial* RealMat
     UnrealMaterial->Expressions.Add(Param);
     Param->MaterialExpressionEditorX = -PosX;
     Param->MaterialExpressionEditorY = GetPosY(324);
-    Param->ParameterName = *P.Key;
+    Param->ParameterName = P.Key;
     Param->DefaultValue = P.Value;
     Input->Expression = Param;
     Input = &Add->B;
@@ -950,37 +1504,44 @@ void REWorker::SetupMasterMaterial(UMaterial* UnrealMaterial, RMaterial* RealMat
   {
     UMaterialExpressionStaticSwitchParameter* Param = NewObject<UMaterialExpressionStaticSwitchParameter>(UnrealMaterial);
     UnrealMaterial->Expressions.Add(Param);
-    Param->ParameterName = *P.Key;
+    Param->ParameterName = P.Key;
     Param->MaterialExpressionEditorX = GetPosX(340);
     Param->MaterialExpressionEditorY = 580;
     Param->DefaultValue = P.Value;
   }
 
-  UnrealMaterial->PostEditChange();
+  if (FDeferredMaterialCompile* Deferred = FDeferredMaterialCompile::Get())
+  {
+    Deferred->Add(UnrealMaterial);
+  }
+  else
+  {
+    UnrealMaterial->PostEditChange();
+  }
   RealMaterial->UnrealMaterial = UnrealMaterial;
 }
 
 TArray<UObject*> REWorker::CreateMaterialInstance(RMaterial* RealMaterial, UFactory* MiFactory, bool& Error)
 {
   TArray<UObject*> Result;
-  if (RealMaterial->Parent)
-  {
-    // Create parent Material Instances
-    TArray<UObject*> Tmp;
-    Tmp = CreateMaterialInstance(RealMaterial->Parent, MiFactory, Error);
-    if (Tmp.Num())
-    {
-      Result.Insert(Tmp, Result.Num() - 1);
-    }
-  }
-  else
+  if (RealMaterial->UnrealMaterial)
   {
+    // The Material Instance has been created earlier
     return Result;
   }
 
-  if (RealMaterial->UnrealMaterial)
+  // Callers create parents before their children. A batched import may have unloaded the parent since.
+  UMaterialInterface* ParentMaterial = nullptr;
+  if (RealMaterial->Parent)
   {
-    // The Material Instance has been created earlier
+    ParentMaterial = RealMaterial->Parent->UnrealMaterial ? Cast<UMaterialInterface>(RealMaterial->Parent->UnrealMaterial) : FindResource<UMaterialInterface>(RealMaterial->Parent->Name);
+    // Siblings share the reloaded parent. REImportBatch unloads it with the batch.
+    RealMaterial->Parent->UnrealMaterial = ParentMaterial;
+  }
+  if (!ParentMaterial)
+  {
+    UE_LOG(LogTemp, Error, TEXT("RE Helper: Failed to create Material Instance \"%s\". Its parent \"%s\" wasn't created."), *RealMaterial->Name, *RealMaterial->ParentName);
+    Error = true;
     return Result;
   }
 
@@ -990,47 +1551,47 @@ TArray<UObject*> REWorker::CreateMaterialInstance(RMaterial* RealMaterial, UFact
     return Result;
   }
 
-  Cast<UMaterialInstanceConstantFactoryNew>(MiFactory)->InitialParent = Cast<UMaterialInterface>(RealMaterial->Parent->UnrealMaterial);
+  Cast<UMaterialInstanceConstantFactoryNew>(MiFactory)->InitialParent = ParentMaterial;
   if (UMaterialInstanceConstant* Asset = CreateAsset<UMaterialInstanceConstant>(RealMaterial->Name, MiFactory))
   {
     RealMaterial->UnrealMaterial = Asset;
     Result.Add(Cast<UObject>(Asset));
     for (const auto& P : RealMaterial->TextureParameters)
     {
-      if (!P.Value.Len() || P.Value == TEXT("None"))
+      if (P.Value.IsNone())
       {
         continue;
       }
 
-      if (UTexture* Texture = FindResource<UTexture>(P.Value))
+      if (UTexture* Texture = FindResource<UTexture>(P.Value.ToString()))
       {
         FMaterialParameterInfo Info;
-        Info.Name = *P.Key;
+        Info.Name = P.Key;
         Asset->SetTextureParameterValueEditorOnly(Info, Texture);
       }
       else
       {
-        UE_LOG(LogTemp, Error, TEXT("RE Helper: Failed to find Texture \"%s\" for parameter \"%s\" of Material Instance \"%s\""), *P.Value, *P.Key, *RealMaterial->Name);
+        UE_LOG(LogTemp, Error, TEXT("RE Helper: Failed to find Texture \"%s\" for parameter \"%s\" of Material Instance \"%s\""), *P.Value.ToString(), *P.Key.ToString(), *RealMaterial->Name);
         Error = true;
       }
     }
 
     for (const auto& P : RealMaterial->TextureAParameters)
     {
-      if (!P.Value.Len() || P.Value == TEXT("None"))
+      if (P.Value.IsNone())
       {
         continue;
       }
 
-      if (UTexture* Texture = FindResource<UTexture>(P.Value))
+      if (UTexture* Texture = FindResource<UTexture>(P.Value.ToString()))
       {
         FMaterialParameterInfo Info;
-        Info.Name = *P.Key;
+        Info.Name = P.Key;
         Asset->SetTextureParameterValueEditorOnly(Info, Texture);
       }
       else
       {
-        UE_LOG(LogTemp, Error, TEXT("RE Helper: Failed to find Texture \"%s\" for parameter \"%s\" of Material Instance \"%s\""), *P.Value, *P.Key, *RealMaterial->Name);
+        UE_LOG(LogTemp, Error, TEXT("RE Helper: Failed to find Texture \"%s\" for parameter \"%s\" of Material Instance \"%s\""), *P.Value.ToString(), *P.Key.ToString(), *RealMaterial->Name);
         Error = true;
       }
     }
@@ -1038,18 +1599,25 @@ TArray<UObject*> REWorker::CreateMaterialInstance(RMaterial* RealMaterial, UFact
     for (const auto& P : RealMaterial->ScalarParameters)
     {
       FMaterialParameterInfo Info;
-      Info.Name = *P.Key;
+      Info.Name = P.Key;
       Asset->SetScalarParameterValueEditorOnly(Info, P.Value);
     }
 
     for (const auto& P : RealMaterial->VectorParameters)
     {
       FMaterialParameterInfo Info;
-      Info.Name = *P.Key;
+      Info.Name = P.Key;
       Asset->SetVectorParameterValueEditorOnly(Info, P.Value);
     }
 
-    Asset->PostEditChange();
+    if (FDeferredMaterialCompile* Deferred = FDeferredMaterialCompile::Get())
+    {
+      Deferred->Add(Asset);
+    }
+    else
+    {
+      Asset->PostEditChange();
+    }
   }
   else
   {
@@ -1061,9 +1629,16 @@ TArray<UObject*> REWorker::CreateMaterialInstance(RMaterial* RealMaterial, UFact
 
 UObject* REWorker::ImportSingleCue(const FString& Path, FString& OutError)
 {
-  TArray<FString> Items;
-  FFileHelper::LoadFileToStringArray(Items, *Path);
-  if (!Items.Num())
+  TArray<FDumpCue> Cues;
+  REDump::ParseCues({ Path }, Cues);
+  return ImportSingleCue(Cues[0], OutError);
+}
+
+UObject* REWorker::ImportSingleCue(const FDumpCue& Entry, FString& OutError)
+{
+  FScopedPackageSave PackageSave;
+  const FString& Path = Entry.File;
+  if (Entry.bEmpty)
   {
     UE_LOG(LogTemp, Error, TEXT("RE Helper: SoundCue \"%s\" file is empty!"), *Path);
     OutError = TEXT("The file \"");
@@ -1071,26 +1646,28 @@ UObject* REWorker::ImportSingleCue(const FString& Path, FString& OutError)
     return nullptr;
   }
 
-  FString CuePath;
-  for (const FString& Line : Items)
+  const REDumpCore::CueEntry& Cue = Entry.Cue;
+  if (!Entry.bParsed)
   {
-    if (Line.Len() < 2)
+    if (Cue.Path.empty())
     {
-      continue;
+      UE_LOG(LogTemp, Error, TEXT("RE Helper: SoundCue \"%s\" file is malformed and has no in-game path!"), *Path);
+      OutError = TEXT("The file \"");
+      OutError += Path + TEXT("\" has no in-game path!");
+    }
+    else
+    {
+      UE_LOG(LogTemp, Error, TEXT("RE Helper: [%s] %s"), *Path, UTF8_TO_TCHAR(Entry.ParseError));
+      OutError = TEXT("Malformed file! See log for more details.");
     }
-    CuePath = Line;
-    break;
-  }
-  if (!CuePath.Len())
-  {
-    UE_LOG(LogTemp, Error, TEXT("RE Helper: SoundCue \"%s\" file is malformed and has no in-game path!"), *Path);
-    OutError = TEXT("The file \"");
-    OutError += Path + TEXT("\" has no in-game path!");
     return nullptr;
   }
+
+  const FString CuePath = ToFString(Cue.Path);
   USoundCueFactoryNew* CueFactory = NewObject<USoundCueFactoryNew>();
-  USoundCue* Asset = FindResource<USoundCue>(CuePath);
-  if (!Asset)
+  // Existing cues are skipped. Don't load them just to find that out.
+  USoundCue* Asset = nullptr;
+  if (!REResolver::Exists<USoundCue>(CuePath))
   {
     Asset = CreateAsset<USoundCue>(CuePath, CueFactory);
     if (!Asset)
@@ -1107,86 +1684,58 @@ UObject* REWorker::ImportSingleCue(const FString& Path, FString& OutError)
     return nullptr;
   }
 
-  USoundNode* RootNode = nullptr;
-  TMap<int32, USoundNode*> SoundNodes;
-  int32 NodesStartIdx = INDEX_NONE;
-  for (int32 LIdx = 1; LIdx < Items.Num(); ++LIdx)
+  if (Cue.Volume)
   {
-    FString Line = Items[LIdx];
-    if (Line.Len() <= 2 || Line.StartsWith(TEXT("\t")) || Line.StartsWith(TEXT(" ")))
-    {
-      continue;
-    }
-    if (Line.StartsWith(TEXT("Nodes:")))
-    {
-      if (NodesStartIdx != INDEX_NONE)
-      {
-        UE_LOG(LogTemp, Error, TEXT("RE Helper: Unexpected \"Nodes\" tag!"), *CuePath);
-        OutError = TEXT("Malformed file! See log for more details.");
-        ObjectTools::DeleteSingleObject(Asset);
-        return nullptr;
-      }
-      NodesStartIdx = LIdx + 1;
-      continue;
-    }
-    else if (NodesStartIdx == INDEX_NONE)
-    {
-      if (Line.StartsWith("Volume="))
-      {
-        Asset->VolumeMultiplier = FCString::Atof(*(Line.Mid(7)));
-        continue;
-      }
-      if (Line.StartsWith("Pitch="))
-      {
-        Asset->PitchMultiplier = FCString::Atof(*(Line.Mid(6)));
-        continue;
-      }
-      if (Line.StartsWith("MaxConcurrentPlayCount="))
-      {
-        Asset->bOverrideConcurrency = 1;
-        Asset->ConcurrencyOverrides.MaxCount = FCString::Atoi(*(Line.Mid(6)));
-        continue;
-      }
-    }
-    int32 Pos1 = Line.Find(VSEP);
-    if (Pos1 == INDEX_NONE)
-    {
-      continue;
-    }
-    int32 Index = FCString::Atoi(*Line.Mid(0, Pos1));
-    FString NodeClass = Line.Mid(Pos1 + 1);
+    Asset->VolumeMultiplier = *Cue.Volume;
+  }
+  if (Cue.Pitch)
+  {
+    Asset->PitchMultiplier = *Cue.Pitch;
+  }
+  if (Cue.MaxConcurrentPlayCount)
+  {
+    Asset->bOverrideConcurrency = 1;
+    Asset->ConcurrencyOverrides.MaxCount = *Cue.MaxConcurrentPlayCount;
+  }
 
+  TMap<int32, USoundNode*> SoundNodes;
+  TArray<USoundNode*> Nodes;
+  Nodes.Reserve((int32)Cue.Nodes.size());
+  for (const REDumpCore::CueNode& Node : Cue.Nodes)
+  {
+    const FString NodeClass = ToFString(Node.Class);
+    USoundNode* SoundNode = nullptr;
     if (NodeClass == "SoundNodeWave")
     {
-      SoundNodes.Add(Index, Asset->ConstructSoundNode<USoundNodeWavePlayer>());
+      SoundNode = Asset->ConstructSoundNode<USoundNodeWavePlayer>();
     }
     else if (NodeClass == "SoundNodeRandom")
     {
-      SoundNodes.Add(Index, Asset->ConstructSoundNode<USoundNodeRandom>());
+      SoundNode = Asset->ConstructSoundNode<USoundNodeRandom>();
     }
     else if (NodeClass == "SoundNodeMixer")
     {
-      SoundNodes.Add(Index, Asset->ConstructSoundNode<USoundNodeMixer>());
+      SoundNode = Asset->ConstructSoundNode<USoundNodeMixer>();
     }
     else if (NodeClass == "SoundNodeModulator")
     {
-      SoundNodes.Add(Index, Asset->ConstructSoundNode<USoundNodeModulator>());
+      SoundNode = Asset->ConstructSoundNode<USoundNodeModulator>();
     }
     else if (NodeClass == "SoundNodeDelay")
     {
-      SoundNodes.Add(Index, Asset->ConstructSoundNode<USoundNodeDelay>());
+      SoundNode = Asset->ConstructSoundNode<USoundNodeDelay>();
     }
     else if (NodeClass == "SoundNodeConcatenator")
     {
-      SoundNodes.Add(Index, Asset->ConstructSoundNode<USoundNodeConcatenator>());
+      SoundNode = Asset->ConstructSoundNode<USoundNodeConcatenator>();
     }
     else if (NodeClass == "SoundNodeLoop")
     {
-      SoundNodes.Add(Index, Asset->ConstructSoundNode<USoundNodeLooping>());
+      SoundNode = Asset->ConstructSoundNode<USoundNodeLooping>();
     }
     else if (NodeClass == "SoundNodeAttenuation")
     {
-      SoundNodes.Add(Index, Asset->ConstructSoundNode<USoundNodeAttenuation>());
+      SoundNode = Asset->ConstructSoundNode<USoundNodeAttenuation>();
     }
     else
     {
@@ -1195,342 +1744,175 @@ UObject* REWorker::ImportSingleCue(const FString& Path, FString& OutError)
       ObjectTools::DeleteSingleObject(Asset);
       return nullptr;
     }
-
-    if (!RootNode)
-    {
-      RootNode = SoundNodes.FindChecked(Index);
-    }
-  }
-
-  if (NodesStartIdx == INDEX_NONE || !RootNode)
-  {
-    UE_LOG(LogTemp, Error, TEXT("RE Helper: Failed to find a root node!"));
-    OutError = TEXT("Malformed file! See log for more details.");
-    ObjectTools::DeleteSingleObject(Asset);
-    return nullptr;
+    SoundNodes.Add(Node.Index, SoundNode);
+    Nodes.Add(SoundNode);
   }
 
+  USoundNode* RootNode = Nodes[0];
   Asset->FirstNode = RootNode;
   RootNode->GetGraphNode()->NodePosX = -270;
 
-  bool IsError = false;
-  FString LastClass;
-  int32 LastIndex = INDEX_NONE;
-  for (int32 LIdx = NodesStartIdx; LIdx < Items.Num(); ++LIdx)
+  const int32 DistanceX = 270;
+  const int32 DistanceY = 130;
+  for (int32 NodeIdx = 0; NodeIdx < Nodes.Num(); ++NodeIdx)
   {
-    FString Line = Items[LIdx];
-    if (Line.Len() <= 2)
-    {
-      continue;
-    }
-    if (!Line.StartsWith(TEXT("\t")))
-    {
-      IsError = false;
-      int32 Pos1 = Line.Find(VSEP);
-      if (Pos1 == INDEX_NONE)
-      {
-        continue;
-      }
-      LastIndex = FCString::Atoi(*Line.Mid(0, Pos1));
-      LastClass = Line.Mid(Pos1 + 1);
-    }
-    else if (IsError)
-    {
-      continue;
-    }
-    USoundNode* Untyped = (USoundNode*)SoundNodes.FindChecked(LastIndex);
-    if (!Untyped)
-    {
-      continue;
-    }
-
-    FString Formatted = Line.Mid(1);
-    TArray<USoundNode*> Children;
-    TArray<float> Weights;
-    TArray<float> Volumes;
-    TArray<float> Pitches;
+    const REDumpCore::CueNode& Node = Cue.Nodes[NodeIdx];
+    USoundNode* Untyped = Nodes[NodeIdx];
 
-    if (Formatted.StartsWith(TEXT("Children")))
+    if (Node.Children)
     {
-      int32 Pos = Formatted.Find("=(");
-      FString Cutted = Formatted.Mid(Pos + 2, Formatted.Len() - Pos - 3);
-      if (!Cutted.Len())
+      TArray<USoundNode*> Children;
+      for (int32 ChildIndex : Node.Children->Indices)
       {
-        continue;
+        if (USoundNode** Child = SoundNodes.Find(ChildIndex))
+        {
+          Children.Add(*Child);
+        }
+        else
+        {
+          UE_LOG(LogTemp, Error, TEXT("RE Helper: [%s] Node %d has an unknown child %d"), *CuePath, Node.Index, ChildIndex);
+          OutError = TEXT("Some errors occured. See the Output Log for details.");
+        }
       }
-      TArray<FString> RawItems;
-      Cutted.Replace(TEXT("("), TEXT("")).ParseIntoArray(RawItems, TEXT(")"), true);
-      for (int32 RawIndex = 0; RawIndex < RawItems.Num(); ++RawIndex)
+      if (Children.Num() && !Untyped->IsA<USoundNodeWavePlayer>())
       {
-        FString RawItem = RawItems[RawIndex];
-        if (RawItem.StartsWith(TEXT(",")))
+        for (int32 MinIdx = 0; MinIdx < Children.Num(); ++MinIdx)
         {
-          RawItem = RawItem.Mid(1);
+          Untyped->InsertChildNode(MinIdx);
         }
-        Pos = RawItem.Find(TEXT("="));
-
-        if (RawItem.StartsWith(TEXT("Index")))
+        Untyped->SetChildNodes(Children);
+        int32 OffsetY = Untyped->GetGraphNode()->NodePosY;
+        for (int32 ChIndex = Children.Num() - 1; ChIndex >= 0; --ChIndex)
         {
-          int32 MapKey = FCString::Atoi(*(RawItem.Mid(Pos + 1)));
-          Children.Add((USoundNode*)SoundNodes.FindChecked(MapKey));
+          USoundNode* Child = Children[ChIndex];
+          USoundCueGraphNode* SoundGraphNode = Cast<USoundCueGraphNode>(Untyped->GetGraphNode());
+          Child->GetGraphNode()->NodePosX = Untyped->GetGraphNode()->NodePosX - SoundGraphNode->EstimateNodeWidth() - DistanceX;
+          Child->GetGraphNode()->NodePosY = OffsetY + (ChIndex * DistanceY);
         }
-        else if (RawItem.StartsWith(TEXT("Weight")))
+        if (USoundNodeRandom* Random = Cast<USoundNodeRandom>(Untyped))
         {
-          Weights.Add(FCString::Atof(*(RawItem.Mid(Pos + 1))));
+          if (Node.Children->Weights.size())
+          {
+            Random->Weights = TArray<float>(Node.Children->Weights.data(), (int32)Node.Children->Weights.size());
+          }
         }
-        else if (RawItem.StartsWith(TEXT("Volume")))
+        else if (USoundNodeMixer* Mixer = Cast<USoundNodeMixer>(Untyped))
         {
-          Volumes.Add(FCString::Atof(*(RawItem.Mid(Pos + 1))));
+          if (Node.Children->Volumes.size())
+          {
+            Mixer->InputVolume = TArray<float>(Node.Children->Volumes.data(), (int32)Node.Children->Volumes.size());
+          }
         }
-        else if (RawItem.StartsWith(TEXT("Pitch")))
+        else if (USoundNodeConcatenator* Concatenator = Cast<USoundNodeConcatenator>(Untyped))
         {
-          Pitches.Add(FCString::Atof(*(RawItem.Mid(Pos + 1))));
+          if (Node.Children->Volumes.size())
+          {
+            Concatenator->InputVolume = TArray<float>(Node.Children->Volumes.data(), (int32)Node.Children->Volumes.size());
+          }
         }
       }
     }
 
-    const int32 DistanceX = 270;
-    const int32 DistanceY = 130;
-    if (LastClass == "SoundNodeWave")
+    if (USoundNodeAttenuation* Tnode = Cast<USoundNodeAttenuation>(Untyped))
     {
-      USoundNodeWavePlayer* TNode = (USoundNodeWavePlayer*)Untyped;
-      if (Formatted.StartsWith(TEXT("Looping")))
-      {
-        int32 Pos1 = Line.Find(TEXT("="));
-        TNode->bLooping = FCString::ToBool(*Line.Mid(Pos1 + 1));
-      }
-      else if (Formatted.StartsWith(TEXT("Sound")))
-      {
-        int32 Pos1 = Line.Find(TEXT("="));
-        if (USoundWave* Wave = FindResource<USoundWave>(Line.Mid(Pos1 + 1)))
-        {
-          TNode->SetSoundWave(Wave);
-        }
-        else
-        {
-          UE_LOG(LogTemp, Error, TEXT("RE Helper: Failed to find SoundWave \"%s\""), *(Line.Mid(Pos1 + 1)));
-          OutError = TEXT("Some errors occured. See the Output Log for details.");
-          IsError = true;
-        }
-      }
+      Tnode->bOverrideAttenuation = 1;
     }
-    else if (LastClass == "SoundNodeRandom")
+
+    for (const REDumpCore::CueProperty& Property : Node.Properties)
     {
-      USoundNodeRandom* TNode = (USoundNodeRandom*)Untyped;
-      if (Formatted.StartsWith(TEXT("Children")))
+      const FString Key = ToFString(Property.Key);
+      if (USoundNodeWavePlayer* TNode = Cast<USoundNodeWavePlayer>(Untyped))
       {
-        for (int32 MinIdx = 0; MinIdx < Children.Num(); ++MinIdx)
-        {
-          TNode->InsertChildNode(MinIdx);
-        }
-        TNode->SetChildNodes(Children);
-        int32 OffsetY = TNode->GetGraphNode()->NodePosY;
-        for (int32 ChIndex = Children.Num() - 1; ChIndex >= 0; --ChIndex)
+        if (Key == TEXT("Looping"))
         {
-          USoundNode* Child = Children[ChIndex];
-          USoundCueGraphNode* SoundGraphNode = Cast<USoundCueGraphNode>(TNode->GetGraphNode());
-          Child->GetGraphNode()->NodePosX = TNode->GetGraphNode()->NodePosX - SoundGraphNode->EstimateNodeWidth() - DistanceX;
-          Child->GetGraphNode()->NodePosY = OffsetY + (ChIndex * DistanceY);
+          TNode->bLooping = REDumpCore::ToBool(Property.Value);
         }
-        if (Weights.Num())
+        else if (Key == TEXT("Sound"))
         {
-          TNode->Weights = Weights;
+          const FString WavePath = ToFString(Property.Value);
+          if (USoundWave* Wave = FindResource<USoundWave>(WavePath))
+          {
+            TNode->SetSoundWave(Wave);
+          }
+          else
+          {
+            UE_LOG(LogTemp, Error, TEXT("RE Helper: Failed to find SoundWave \"%s\""), *WavePath);
+            OutError = TEXT("Some errors occured. See the Output Log for details.");
+            // Skip the rest of the node
+            break;
+          }
         }
       }
-    }
-    else if (LastClass == "SoundNodeMixer")
-    {
-      USoundNodeMixer* TNode = (USoundNodeMixer*)Untyped;
-      if (Formatted.StartsWith(TEXT("Children")))
+      else if (USoundNodeModulator* TNode = Cast<USoundNodeModulator>(Untyped))
       {
-        for (int32 MinIdx = 0; MinIdx < Children.Num(); ++MinIdx)
+        if (Key == TEXT("PitchMin"))
         {
-          TNode->InsertChildNode(MinIdx);
+          TNode->PitchMin = REDumpCore::ToFloat(Property.Value);
         }
-        TNode->SetChildNodes(Children);
-        int32 OffsetY = TNode->GetGraphNode()->NodePosY;
-        for (int32 ChIndex = Children.Num() - 1; ChIndex >= 0; --ChIndex)
+        else if (Key == TEXT("PitchMax"))
         {
-          USoundNode* Child = Children[ChIndex];
-          USoundCueGraphNode* SoundGraphNode = Cast<USoundCueGraphNode>(TNode->GetGraphNode());
-          Child->GetGraphNode()->NodePosX = TNode->GetGraphNode()->NodePosX - SoundGraphNode->EstimateNodeWidth() - DistanceX;
-          Child->GetGraphNode()->NodePosY = OffsetY + (ChIndex * DistanceY);
+          TNode->PitchMax = REDumpCore::ToFloat(Property.Value);
+        }
+        else if (Key == TEXT("VolumeMin"))
+        {
+          TNode->VolumeMin = REDumpCore::ToFloat(Property.Value);
         }
-        if (Volumes.Num())
+        else if (Key == TEXT("VolumeMax"))
         {
-          TNode->InputVolume = Volumes;
+          TNode->VolumeMax = REDumpCore::ToFloat(Property.Value);
         }
       }
-    }
-    else if (LastClass == "SoundNodeModulator")
-    {
-      USoundNodeModulator* TNode = (USoundNodeModulator*)Untyped;
-      if (Formatted.StartsWith(TEXT("Children")))
+      else if (USoundNodeDelay* TNode = Cast<USoundNodeDelay>(Untyped))
       {
-        for (int32 MinIdx = 0; MinIdx < Children.Num(); ++MinIdx)
+        if (Key == TEXT("DelayMin"))
         {
-          TNode->InsertChildNode(MinIdx);
+          TNode->DelayMin = REDumpCore::ToFloat(Property.Value);
         }
-        TNode->SetChildNodes(Children);
-        int32 OffsetY = TNode->GetGraphNode()->NodePosY;
-        for (int32 ChIndex = Children.Num() - 1; ChIndex >= 0; --ChIndex)
+        else if (Key == TEXT("DelayMax"))
         {
-          USoundNode* Child = Children[ChIndex];
-          USoundCueGraphNode* SoundGraphNode = Cast<USoundCueGraphNode>(TNode->GetGraphNode());
-          Child->GetGraphNode()->NodePosX = TNode->GetGraphNode()->NodePosX - SoundGraphNode->EstimateNodeWidth() - DistanceX;
-          Child->GetGraphNode()->NodePosY = OffsetY + (ChIndex * DistanceY);
+          TNode->DelayMax = REDumpCore::ToFloat(Property.Value);
         }
       }
-      else if (Formatted.StartsWith("PitchMin"))
-      {
-        int32 Pos = Formatted.Find(TEXT("="));
-        TNode->PitchMin = FCString::Atof(*(Formatted.Mid(Pos + 1)));
-      }
-      else if (Formatted.StartsWith("PitchMax"))
-      {
-        int32 Pos = Formatted.Find(TEXT("="));
-        TNode->PitchMax = FCString::Atof(*(Formatted.Mid(Pos + 1)));
-      }
-      else if (Formatted.StartsWith("VolumeMin"))
-      {
-        int32 Pos = Formatted.Find(TEXT("="));
-        TNode->VolumeMin = FCString::Atof(*(Formatted.Mid(Pos + 1)));
-      }
-      else if (Formatted.StartsWith("VolumeMax"))
-      {
-        int32 Pos = Formatted.Find(TEXT("="));
-        TNode->VolumeMax = FCString::Atof(*(Formatted.Mid(Pos + 1)));
-      }
-    }
-    else if (LastClass == "SoundNodeDelay")
-    {
-      USoundNodeDelay* TNode = (USoundNodeDelay*)Untyped;
-      if (Formatted.StartsWith(TEXT("Children")))
+      else if (USoundNodeLooping* TNode = Cast<USoundNodeLooping>(Untyped))
       {
-        for (int32 MinIdx = 0; MinIdx < Children.Num(); ++MinIdx)
+        if (Key == TEXT("bLoopIndefinitely"))
         {
-          TNode->InsertChildNode(MinIdx);
+          TNode->bLoopIndefinitely = false;
         }
-        TNode->SetChildNodes(Children);
-        int32 OffsetY = TNode->GetGraphNode()->NodePosY;
-        for (int32 ChIndex = Children.Num() - 1; ChIndex >= 0; --ChIndex)
+        else if (Key == TEXT("LoopCount"))
         {
-          USoundNode* Child = Children[ChIndex];
-          USoundCueGraphNode* SoundGraphNode = Cast<USoundCueGraphNode>(TNode->GetGraphNode());
-          Child->GetGraphNode()->NodePosX = TNode->GetGraphNode()->NodePosX - SoundGraphNode->EstimateNodeWidth() - DistanceX;
-          Child->GetGraphNode()->NodePosY = OffsetY + (ChIndex * DistanceY);
+          TNode->LoopCount = REDumpCore::ToInt(Property.Value);
         }
       }
-      else if (Formatted.StartsWith("DelayMin"))
-      {
-        int32 Pos = Formatted.Find(TEXT("="));
-        TNode->DelayMin = FCString::Atof(*(Formatted.Mid(Pos + 1)));
-      }
-      else if (Formatted.StartsWith("DelayMax"))
-      {
-        int32 Pos = Formatted.Find(TEXT("="));
-        TNode->DelayMax = FCString::Atof(*(Formatted.Mid(Pos + 1)));
-      }
-    }
-    else if (LastClass == "SoundNodeConcatenator")
-    {
-      USoundNodeConcatenator* TNode = (USoundNodeConcatenator*)Untyped;
-      if (Formatted.StartsWith(TEXT("Children")))
+      else if (USoundNodeAttenuation* Tnode = Cast<USoundNodeAttenuation>(Untyped))
       {
-        for (int32 MinIdx = 0; MinIdx < Children.Num(); ++MinIdx)
+        if (Key == TEXT("RadiusMin"))
         {
-          TNode->InsertChildNode(MinIdx);
+          Tnode->AttenuationOverrides.RadiusMin_DEPRECATED = REDumpCore::ToFloat(Property.Value);
         }
-        TNode->SetChildNodes(Children);
-        int32 OffsetY = TNode->GetGraphNode()->NodePosY;
-        for (int32 ChIndex = Children.Num() - 1; ChIndex >= 0; --ChIndex)
-        {
-          USoundNode* Child = Children[ChIndex];
-          USoundCueGraphNode* SoundGraphNode = Cast<USoundCueGraphNode>(TNode->GetGraphNode());
-          Child->GetGraphNode()->NodePosX = TNode->GetGraphNode()->NodePosX - SoundGraphNode->EstimateNodeWidth() - DistanceX;
-          Child->GetGraphNode()->NodePosY = OffsetY + (ChIndex * DistanceY);
-        }
-        if (Volumes.Num())
+        else if (Key == TEXT("RadiusMax"))
         {
-          TNode->InputVolume = Volumes;
+          float f = REDumpCore::ToFloat(Property.Value);
+          Tnode->AttenuationOverrides.FalloffDistance = f;
+          Tnode->AttenuationOverrides.RadiusMax_DEPRECATED = f;
         }
-      }
-    }
-    else if (LastClass == "SoundNodeLoop")
-    {
-      USoundNodeLooping* TNode = (USoundNodeLooping*)Untyped;
-      if (Formatted.StartsWith(TEXT("Children")))
-      {
-        for (int32 MinIdx = 0; MinIdx < Children.Num(); ++MinIdx)
+        else if (Key == TEXT("LPFRadiusMin"))
         {
-          TNode->InsertChildNode(MinIdx);
+          Tnode->AttenuationOverrides.LPFRadiusMin = REDumpCore::ToFloat(Property.Value);
         }
-        TNode->SetChildNodes(Children);
-        int32 OffsetY = TNode->GetGraphNode()->NodePosY;
-        for (int32 ChIndex = Children.Num() - 1; ChIndex >= 0; --ChIndex)
+        else if (Key == TEXT("LPFRadiusMax"))
         {
-          USoundNode* Child = Children[ChIndex];
-          USoundCueGraphNode* SoundGraphNode = Cast<USoundCueGraphNode>(TNode->GetGraphNode());
-          Child->GetGraphNode()->NodePosX = TNode->GetGraphNode()->NodePosX - SoundGraphNode->EstimateNodeWidth() - DistanceX;
-          Child->GetGraphNode()->NodePosY = OffsetY + (ChIndex * DistanceY);
+          Tnode->AttenuationOverrides.LPFRadiusMax = REDumpCore::ToFloat(Property.Value);
         }
-      }
-      else if (Formatted.StartsWith(TEXT("bLoopIndefinitely")))
-      {
-        TNode->bLoopIndefinitely = false;
-      }
-      else if (Formatted.StartsWith(TEXT("LoopCount")))
-      {
-        int32 Pos = Formatted.Find(TEXT("="));
-        TNode->LoopCount = FCString::Atoi(*(Formatted.Mid(Pos)));
-      }
-    }
-    else if (LastClass == "SoundNodeAttenuation")
-    {
-      USoundNodeAttenuation* Tnode = (USoundNodeAttenuation*)Untyped;
-      Tnode->bOverrideAttenuation = 1;
-      if (Formatted.StartsWith(TEXT("Children")))
-      {
-        for (int32 MinIdx = 0; MinIdx < Children.Num(); ++MinIdx)
+        else if (Key == TEXT("AttenuateWithLPF"))
         {
-          Tnode->InsertChildNode(MinIdx);
+          Tnode->AttenuationOverrides.bAttenuateWithLPF = REDumpCore::ToBool(Property.Value);
         }
-        Tnode->SetChildNodes(Children);
-        int32 OffsetY = Tnode->GetGraphNode()->NodePosY;
-        for (int32 ChIndex = Children.Num() - 1; ChIndex >= 0; --ChIndex)
+        else if (Key == TEXT("Attenuate"))
         {
-          USoundNode* Child = Children[ChIndex];
-          USoundCueGraphNode* SoundGraphNode = Cast<USoundCueGraphNode>(Tnode->GetGraphNode());
-          Child->GetGraphNode()->NodePosX = Tnode->GetGraphNode()->NodePosX - SoundGraphNode->EstimateNodeWidth() - DistanceX;
-          Child->GetGraphNode()->NodePosY = OffsetY + (ChIndex * DistanceY);
+          Tnode->AttenuationOverrides.bAttenuate = REDumpCore::ToBool(Property.Value);
         }
       }
-      else if (Formatted.StartsWith(TEXT("RadiusMin=")))
-      {
-        Tnode->AttenuationOverrides.RadiusMin_DEPRECATED = FCString::Atof(*(Formatted.Mid(Formatted.Find(TEXT("=")) + 1)));
-      }
-      else if (Formatted.StartsWith(TEXT("RadiusMax=")))
-      {
-        float f = FCString::Atof(*(Formatted.Mid(Formatted.Find(TEXT("=")) + 1)));
-        Tnode->AttenuationOverrides.FalloffDistance = f;
-        Tnode->AttenuationOverrides.RadiusMax_DEPRECATED = f;
-      }
-      else if (Formatted.StartsWith(TEXT("LPFRadiusMin=")))
-      {
-        Tnode->AttenuationOverrides.LPFRadiusMin = FCString::Atof(*(Formatted.Mid(Formatted.Find(TEXT("=")) + 1)));
-      }
-      else if (Formatted.StartsWith(TEXT("LPFRadiusMax=")))
-      {
-        Tnode->AttenuationOverrides.LPFRadiusMax = FCString::Atof(*(Formatted.Mid(Formatted.Find(TEXT("=")) + 1)));
-      }
-      else if (Formatted.StartsWith(TEXT("AttenuateWithLPF=")))
-      {
-        Tnode->AttenuationOverrides.bAttenuateWithLPF = FCString::ToBool(*(Formatted.Mid(Formatted.Find(TEXT("=")) + 1)));
-      }
-      else if (Formatted.StartsWith(TEXT("Attenuate=")))
-      {
-        Tnode->AttenuationOverrides.bAttenuate = FCString::ToBool(*(Formatted.Mid(Formatted.Find(TEXT("=")) + 1)));
-      }
     }
   }
 
@@ -1541,35 +1923,76 @@ UObject* REWorker::ImportSingleCue(const FString& Path, FString& OutError)
 
 TArray<UObject*> REWorker::ImportSoundCues(const FString& Path, FString& OutError)
 {
+  FScopedPackageSave PackageSave;
   TArray<UObject*> Result;
-  TArray<FString> Lines;
-  FFileHelper::LoadFileToStringArray(Lines, *Path);
-  if (!Lines.Num())
+  FDumpText Text;
+  const TArray<FAnsiStringView>& Lines = Text.Lines;
+  if (!REDump::LoadText(Path, Text))
   {
     OutError = TEXT("The file appears to be empty!");
     return {};
   }
 
-  FScopedSlowTask Task((float)Lines.Num(), NSLOCTEXT("REHelper", "ImportingCues", "Importing sound cues..."));
+  FScopedResolverCache ResolverCache;
+  // Each cue file is read and parsed once. Validation, preloading and import use the same entries.
+  TArray<FDumpCue> Cues;
+  {
+    TArray<FString> CuePaths;
+    for (const FAnsiStringView& Line : Lines)
+    {
+      if (!Line.StartsWith(' ') && Line.Len() > 2)
+      {
+        CuePaths.Add(REDump::ToFString(Line));
+      }
+    }
+    REDump::ParseCues(CuePaths, Cues);
+  }
+  if (!REValidator::PreflightCues(Path, Cues))
+  {
+    OutError = TEXT("Import cancelled. See the Output Log for the validation report.");
+    return {};
+  }
+
+  FScopedSlowTask Task((float)Cues.Num(), NSLOCTEXT("REHelper", "ImportingCues", "Importing sound cues..."));
   Task.MakeDialog();
+  {
+    TArray<FString> Paths;
+    for (const FDumpCue& Entry : Cues)
+    {
+      if (Entry.bParsed)
+      {
+        GatherCueWaves(Entry.Cue, Paths);
+      }
+    }
+    if (REImportBatch::IsEnabled())
+    {
+      REResolver::PreIndex(Paths);
+    }
+    else
+    {
+      REResolver::Preload(Paths);
+    }
+  }
 
   const int32 DistanceX = 270;
   const int32 DistanceY = 130;
   USoundCueFactoryNew* CueFactory = NewObject<USoundCueFactoryNew>();
-  for (int32 Idx = 0; Idx < Lines.Num(); ++Idx)
+  FScopedImportBatch ImportBatch;
+  FScopedAssetBatch AssetBatch;
+  for (const FDumpCue& Entry : Cues)
   {
     Task.EnterProgressFrame(1.f);
-    if (Lines[Idx].StartsWith(TEXT(" ")) || Lines[Idx].Len() <= 2)
-    {
-      continue;
-    }
-    UObject* Cue = ImportSingleCue(Lines[Idx], OutError);
+    UObject* Cue = ImportSingleCue(Entry, OutError);
     if (!Cue)
     {
       OutError = TEXT("Failed to import some cues! See log for more details.");
       continue;
     }
     Result.Add(Cue);
+    if (REImportBatch::ShouldFlush())
+    {
+      REImportBatch::Flush(Result);
+    }
   }
   return Result;
 }
\ No newline at end of file
@@ -1,5 +1,18 @@
 #pragma once
 #include "CoreMinimal.h"
+#include "Engine/TextureDefines.h"
+#include "REDump.h"
+
+// Textures.txt entries by asset path. Lets material import pick sampler types without inspecting textures.
+struct FTextureMetadata {
+  TArray<RTexture> Textures;
+  // Normalized path to the index in Textures
+  TMap<FString, int32> ByPath;
+
+  // Returns false if the file is missing or empty
+  bool Load(const FString& Path);
+  const RTexture* Find(const FString& TexturePath) const;
+};
 
 class REWorker {
 public:
@@ -7,20 +20,34 @@ public:
   ~REWorker() = delete;
 
   // Load RE material dump and create necessary Materials and Instances. Returns number of created assets or -1 on error.
-  static TArray<class UObject*> ImportMaterials(const FString& Path, FString& OutError);
+  // If TexturesPath is set, sampler types come from Textures.txt and match the settings FixTextures applies.
+  static TArray<class UObject*> ImportMaterials(const FString& Path, FString& OutError, const FString& TexturesPath = FString());
   // Load RE material map and assign existing materials to mesh assets. Returns number of modified assets or -1 on error.
   static int32 AssignDefaultMaterials(const FString& Path, FString& OutError);
   // Apply correct compression settings and SRGB flag to textures. Returns number of modified assets or -1 on error.
-  static int32 FixTextures(const FString& Path, FString& OutError);
+  // OutStats receives the rebuild time and throughput.
+  static int32 FixTextures(const FString& Path, FString& OutError, FString* OutStats = nullptr);
+  // Paste actors from a T3D dump to the World in chunks. Returns number of imported actors or -1 on error.
+  static int32 ImportActors(const FString& Path, UWorld* World, FString& OutError);
+  // REHelper.T3D.ActorsPerChunk
+  static int32 GetT3DActorsPerChunk();
   // Set correct materials for SpeedTree actors in the Level
   static int32 FixSpeedTrees(const FString& Path, ULevel* Level, FString& OutError);
   // Import sound cues
   static TArray<class UObject*> ImportSoundCues(const FString& Path, FString& OutError);
   // Import single/custom sound cue
   static class UObject* ImportSingleCue(const FString& Path, FString& OutError);
+  // Import a cue file parsed by REDump::ParseCues
+  static class UObject* ImportSingleCue(const FDumpCue& Entry, FString& OutError);
+  // Create a Master Material or a Material Instance. Parent of the instance must be linked and created. Returns created assets.
+  static TArray<class UObject*> ImportMaterial(struct RMaterial* Material, class UFactory* MatFactory, class UFactory* MiFactory, bool& Error, const FTextureMetadata* TextureMetadata = nullptr);
+  // Compression settings and SRGB flag for a Textures.txt entry
+  static void GetTextureSettings(const RTexture& Texture, TextureCompressionSettings& OutCompression, bool& OutSRGB);
 private:
+  // Find or create a Master Material. Returns the asset if it was created.
+  static class UObject* CreateMasterMaterial(struct RMaterial* RealMaterial, class UFactory* MatFactory, bool& Error, const FTextureMetadata* TextureMetadata);
   // Create and connect parameters
-  static void SetupMasterMaterial(UMaterial* UnrealMaterial, struct RMaterial* RealMaterial, bool& Error);
-  // Recursively create Material Instance Constants with correct parameter overrides
+  static void SetupMasterMaterial(UMaterial* UnrealMaterial, struct RMaterial* RealMaterial, bool& Error, const FTextureMetadata* TextureMetadata);
+  // Create a Material Instance Constant with correct parameter overrides. The parent must be created first.
   static TArray<class UObject*> CreateMaterialInstance(struct RMaterial* RealMaterial, class UFactory* MiFactory, bool& Error);
 };
\ No newline at end of file
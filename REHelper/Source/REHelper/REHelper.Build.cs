@@ -44,9 +44,15 @@ public class REHelper : ModuleRules
         "Engine",
         "Slate",
         "SlateCore",
+        "Sockets",
+        "Networking",
+        "TargetPlatform",
         // ... add private dependencies that you statically link with here ...	
       }
       );
+
+    // Compressed dumps
+    AddEngineThirdPartyPrivateStaticDependencies(Target, "zlib");
     
     
     DynamicallyLoadedModuleNames.AddRange(
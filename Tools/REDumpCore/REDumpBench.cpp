@@ -0,0 +1,382 @@
+// Parse an RE dump repeatedly and report the throughput. Run it under perf or valgrind to profile the parsers.
+#include "REDumpCore.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+  void PrintUsage()
+  {
+    std::printf(
+      "Usage: REDumpBench [--scalar | --sse2] [--iterations N] <Kind> <Path>\n"
+      "       REDumpBench --generate N <Path>\n"
+      "  Kind: materials, textures, defaults, speedtree, cue, lines or legacy-materials\n"
+      "  --scalar      Disable the vector scanner\n"
+      "  --sse2        Use SSE2 even if the CPU has AVX2\n"
+      "  --iterations  Number of runs. Default is 10.\n"
+      "  --generate    Write a MaterialsList.txt with N synthetic entries\n");
+  }
+
+  bool LoadFile(const char* Path, std::vector<char>& OutData)
+  {
+    std::FILE* File = std::fopen(Path, "rb");
+    if (!File)
+    {
+      return false;
+    }
+    char Buffer[64 * 1024];
+    size_t Count = 0;
+    while ((Count = std::fread(Buffer, 1, sizeof(Buffer), File)) > 0)
+    {
+      OutData.insert(OutData.end(), Buffer, Buffer + Count);
+    }
+    const bool bOk = !std::ferror(File);
+    std::fclose(File);
+    return bOk;
+  }
+
+  struct FRunResult {
+    size_t Lines = 0;
+    size_t Entries = 0;
+    size_t Errors = 0;
+  };
+
+  template <typename TEntry, typename TParser>
+  FRunResult RunParser(std::string_view Text, TParser Parser)
+  {
+    std::vector<TEntry> Entries;
+    std::vector<size_t> ErrorLines;
+    FRunResult Result;
+    Result.Lines = Parser(Text, Entries, ErrorLines);
+    Result.Entries = Entries.size();
+    Result.Errors = ErrorLines.size();
+    return Result;
+  }
+
+  FRunResult RunLines(std::string_view Text)
+  {
+    std::vector<std::string_view> Lines;
+    REDumpCore::SplitLines(Text, Lines);
+    FRunResult Result;
+    Result.Lines = Lines.size();
+    for (std::string_view Line : Lines)
+    {
+      const char* End = Line.data() + Line.size();
+      for (const char* Ptr = REDumpCore::FindChar(Line.data(), End, REDumpCore::VSEP_CHAR); Ptr != End; Ptr = REDumpCore::FindChar(Ptr + 1, End, REDumpCore::VSEP_CHAR))
+      {
+        Result.Entries++;
+      }
+    }
+    return Result;
+  }
+
+  FRunResult RunCue(std::string_view Text)
+  {
+    REDumpCore::CueEntry Cue;
+    const char* Error = nullptr;
+    FRunResult Result;
+    Result.Errors = REDumpCore::ParseCue(Text, Cue, Error) ? 0 : 1;
+    Result.Entries = Cue.Nodes.size();
+    return Result;
+  }
+
+  // MaterialsList.txt parsing before REDumpCore, ported from RMaterial::ReadFromArray with FString replaced by std::string.
+  // Every line is copied on load and every field is copied again by Mid and TrimStartAndEnd. FString is UTF-16 on
+  // Windows and its Find ignored case, so the editor paid more than this port does.
+  struct FLegacyMaterial {
+    std::string Name;
+    std::string Class;
+    std::string ParentName;
+    std::unordered_map<std::string, bool> BoolParameters;
+    std::unordered_map<std::string, float> ScalarParameters;
+    std::unordered_map<std::string, std::string> TextureParameters;
+    std::unordered_map<std::string, std::string> TextureAParameters;
+    std::unordered_map<std::string, std::array<float, 4>> VectorParameters;
+    bool TwoSided = false;
+  };
+
+  std::string LegacyTrim(const std::string& Line)
+  {
+    const size_t Begin = Line.find_first_not_of(" \t");
+    return Begin == std::string::npos ? std::string() : Line.substr(Begin, Line.find_last_not_of(" \t") - Begin + 1);
+  }
+
+  bool LegacyReadFromArray(const std::vector<std::string>& Lines, size_t& Idx, FLegacyMaterial& Material)
+  {
+    const std::string& Line = Lines[Idx];
+    size_t Pos1 = Line.find(' ');
+    if (Pos1 == std::string::npos)
+    {
+      return false;
+    }
+    Material.Class = Line.substr(0, Pos1);
+    size_t Pos2 = 0;
+    if (Material.Class == "Material")
+    {
+      Material.ParentName.clear();
+      Material.Name = Line.substr(Pos1 + 1);
+    }
+    else
+    {
+      Pos2 = Line.find(' ', Pos1 + 1);
+      if (Pos2 == std::string::npos)
+      {
+        return false;
+      }
+      Material.ParentName = Line.substr(Pos1 + 1, Pos2 - Pos1 - 1);
+      Material.Name = Line.substr(Pos2 + 1);
+    }
+
+    while (++Idx < Lines.size())
+    {
+      if (Lines[Idx].empty() || Lines[Idx][0] != ' ')
+      {
+        break;
+      }
+      const std::string Trimmed = LegacyTrim(Lines[Idx]);
+      if (Trimmed == "TwoSided")
+      {
+        Material.TwoSided = true;
+        continue;
+      }
+      Pos1 = Trimmed.find(REDumpCore::VSEP_CHAR);
+      Pos2 = Pos1 == std::string::npos ? Pos1 : Trimmed.find(REDumpCore::VSEP_CHAR, Pos1 + 1);
+      if (Pos2 == std::string::npos)
+      {
+        break;
+      }
+      const std::string Type = Trimmed.substr(0, Pos1);
+      const std::string Parameter = Trimmed.substr(Pos1 + 1, Pos2 - Pos1 - 1);
+      if (Type == "Texture")
+      {
+        Material.TextureParameters[Parameter] = Trimmed.substr(Pos2 + 1);
+      }
+      else if (Type == "TextureA")
+      {
+        const std::string Value = Trimmed.substr(Pos2 + 1);
+        Material.TextureParameters[Parameter] = Value;
+        Material.TextureAParameters[Parameter + "_Alpha"] = Value + "_Alpha";
+      }
+      else if (Type == "Scalar")
+      {
+        Material.ScalarParameters[Parameter] = (float)std::atof(Trimmed.substr(Pos2 + 1).c_str());
+      }
+      else if (Type == "Bool")
+      {
+        const std::string Value = Trimmed.substr(Pos2 + 1);
+        Material.BoolParameters[Parameter] = Value == "True" || Value == "true" || Value == "1";
+      }
+      else if (Type == "Vector")
+      {
+        std::array<float, 4> Color = {};
+        for (size_t Channel = 0; Channel < 3; ++Channel)
+        {
+          Pos1 = Pos2;
+          Pos2 = Trimmed.find(REDumpCore::VSEP_CHAR, Pos1 + 1);
+          if (Pos2 == std::string::npos)
+          {
+            return true;
+          }
+          Color[Channel] = (float)std::atof(Trimmed.substr(Pos1 + 1, Pos2 - Pos1 - 1).c_str());
+        }
+        Color[3] = (float)std::atof(Trimmed.substr(Pos2 + 1).c_str());
+        Material.VectorParameters[Parameter] = Color;
+      }
+    }
+    Idx--;
+    return true;
+  }
+
+  FRunResult RunLegacyMaterials(std::string_view Text)
+  {
+    // FFileHelper::LoadFileToStringArray
+    std::vector<std::string> Lines;
+    for (size_t Pos = 0; Pos < Text.size();)
+    {
+      size_t Eol = Text.find('\n', Pos);
+      Eol = Eol == std::string_view::npos ? Text.size() : Eol;
+      const size_t LineEnd = Eol > Pos && Text[Eol - 1] == '\r' ? Eol - 1 : Eol;
+      if (LineEnd > Pos)
+      {
+        Lines.emplace_back(Text.substr(Pos, LineEnd - Pos));
+      }
+      Pos = Eol + 1;
+    }
+
+    FRunResult Result;
+    Result.Lines = Lines.size();
+    std::vector<FLegacyMaterial> Materials;
+    for (size_t Idx = 0; Idx < Lines.size(); ++Idx)
+    {
+      if (Lines[Idx][0] == ' ')
+      {
+        continue;
+      }
+      FLegacyMaterial Material;
+      if (!LegacyReadFromArray(Lines, Idx, Material))
+      {
+        Result.Errors++;
+        continue;
+      }
+      // TArray::Add copied the record
+      Materials.push_back(Material);
+    }
+    Result.Entries = Materials.size();
+    return Result;
+  }
+
+  // Masters every 8 entries, the rest are instances of the latest master
+  bool GenerateMaterials(size_t Count, const char* Path)
+  {
+    std::FILE* File = std::fopen(Path, "wb");
+    if (!File)
+    {
+      return false;
+    }
+    size_t Master = 0;
+    for (size_t Idx = 0; Idx < Count; ++Idx)
+    {
+      if (Idx % 8 == 0)
+      {
+        Master = Idx;
+        std::fprintf(File, "Material Materials/Masters/M_Master_%zu\n", Idx);
+        std::fprintf(File, " TwoSided\n");
+        std::fprintf(File, " Texture\tDiffuse\tTextures/Zone_%zu/T_Diffuse_%zu_D\n", Idx % 97, Idx);
+        std::fprintf(File, " Texture\tNormal\tTextures/Zone_%zu/T_Normal_%zu_N\n", Idx % 97, Idx);
+        std::fprintf(File, " Texture\tSpecular\tTextures/Zone_%zu/T_Specular_%zu_S\n", Idx % 97, Idx);
+        std::fprintf(File, " Scalar\tSpecularPower\t%zu.25\n", Idx % 64);
+        std::fprintf(File, " Vector\tTint\t1\t0.5\t0.25\t1\n");
+        continue;
+      }
+      std::fprintf(File, "MaterialInstanceConstant Materials/Masters/M_Master_%zu Materials/Zone_%zu/MI_Instance_%zu\n", Master, Idx % 97, Idx);
+      std::fprintf(File, " Texture\tDiffuse\tTextures/Zone_%zu/T_Diffuse_%zu_D\n", Idx % 97, Idx);
+      std::fprintf(File, " TextureA\tMask\tTextures/Zone_%zu/T_Mask_%zu_M\n", Idx % 97, Idx);
+      std::fprintf(File, " Scalar\tOpacity\t0.%zu\n", Idx % 10);
+      std::fprintf(File, " Scalar\tEmissiveScale\t%zu.5\n", Idx % 16);
+      std::fprintf(File, " Vector\tTint\t0.75\t0.5\t0.%zu\t1\n", Idx % 10);
+      std::fprintf(File, " Bool\tUseMask\t%s\n", Idx % 2 ? "True" : "False");
+    }
+    const bool bOk = !std::ferror(File);
+    std::fclose(File);
+    return bOk;
+  }
+
+  bool Run(const std::string& Kind, std::string_view Text, FRunResult& OutResult)
+  {
+    if (Kind == "materials")
+    {
+      OutResult = RunParser<REDumpCore::MaterialEntry>(Text, REDumpCore::ParseMaterials);
+    }
+    else if (Kind == "textures")
+    {
+      OutResult = RunParser<REDumpCore::TextureEntry>(Text, REDumpCore::ParseTextures);
+    }
+    else if (Kind == "defaults")
+    {
+      OutResult = RunParser<REDumpCore::DefaultMaterialsEntry>(Text, REDumpCore::ParseDefaultMaterials);
+    }
+    else if (Kind == "speedtree")
+    {
+      OutResult = RunParser<REDumpCore::SpeedTreeOverrideEntry>(Text, REDumpCore::ParseSpeedTreeOverrides);
+    }
+    else if (Kind == "cue")
+    {
+      OutResult = RunCue(Text);
+    }
+    else if (Kind == "lines")
+    {
+      OutResult = RunLines(Text);
+    }
+    else if (Kind == "legacy-materials")
+    {
+      OutResult = RunLegacyMaterials(Text);
+    }
+    else
+    {
+      return false;
+    }
+    return true;
+  }
+}
+
+int main(int Argc, char** Argv)
+{
+  int Iterations = 10;
+  std::vector<const char*> Positional;
+  for (int Idx = 1; Idx < Argc; ++Idx)
+  {
+    if (!std::strcmp(Argv[Idx], "--scalar"))
+    {
+      REDumpCore::SetForceScalar(true);
+    }
+    else if (!std::strcmp(Argv[Idx], "--sse2"))
+    {
+      if (!REDumpCore::SetInstructionSet(REDumpCore::EInstructionSet::SSE2))
+      {
+        std::fprintf(stderr, "The CPU has no SSE2\n");
+        return 1;
+      }
+    }
+    else if (!std::strcmp(Argv[Idx], "--generate") && Idx + 2 < Argc)
+    {
+      const size_t Count = (size_t)std::max(1, std::atoi(Argv[Idx + 1]));
+      if (!GenerateMaterials(Count, Argv[Idx + 2]))
+      {
+        std::fprintf(stderr, "Failed to write \"%s\"\n", Argv[Idx + 2]);
+        return 1;
+      }
+      return 0;
+    }
+    else if (!std::strcmp(Argv[Idx], "--iterations") && Idx + 1 < Argc)
+    {
+      Iterations = std::max(1, std::atoi(Argv[++Idx]));
+    }
+    else
+    {
+      Positional.push_back(Argv[Idx]);
+    }
+  }
+  if (Positional.size() != 2)
+  {
+    PrintUsage();
+    return 1;
+  }
+
+  const std::string Kind = Positional[0];
+  std::vector<char> Data;
+  if (!LoadFile(Positional[1], Data))
+  {
+    std::fprintf(stderr, "Failed to read \"%s\"\n", Positional[1]);
+    return 1;
+  }
+  const std::string_view Text = REDumpCore::SkipBom(std::string_view(Data.data(), Data.size()));
+
+  double Best = 0.;
+  double Total = 0.;
+  FRunResult Result;
+  for (int Iteration = 0; Iteration < Iterations; ++Iteration)
+  {
+    const auto Start = std::chrono::steady_clock::now();
+    if (!Run(Kind, Text, Result))
+    {
+      PrintUsage();
+      return 1;
+    }
+    const double Seconds = std::max(std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count(), 1e-9);
+    Best = Iteration ? std::min(Best, Seconds) : Seconds;
+    Total += Seconds;
+  }
+
+  const double MegaBytes = Data.size() / (1024. * 1024.);
+  std::printf("%s: %s, %.2f MB, %zu lines, %zu entries, %zu errors\n", Kind.c_str(), REDumpCore::GetInstructionSetName(), MegaBytes, Result.Lines, Result.Entries, Result.Errors);
+  std::printf("best %.2f ms (%.1f MB/s), mean %.2f ms over %d runs\n", Best * 1000., MegaBytes / Best, Total / Iterations * 1000., Iterations);
+  return Result.Errors ? 2 : 0;
+}
@@ -0,0 +1,12 @@
+﻿Sounds/Cues/C_Test
+Volume=0.8
+Pitch=1.1
+MaxConcurrentPlayCount=4
+Nodes:
+0	SoundNodeRandom
+	Children=((Index=1,Weight=0.5),(Index=2,Weight=0.5))
+	bRandomizeWithoutReplacement=True
+1	SoundNodeWavePlayer
+	Sound=Sounds/Waves/W_A
+2	SoundNodeWavePlayer
+	Sound=Sounds/Waves/W_B
@@ -0,0 +1,2 @@
+Sounds/Cues/C_NoNodes
+Volume=1
@@ -0,0 +1,4 @@
+Sounds/Cues/C_TwoLists
+Nodes:
+0	SoundNodeWavePlayer
+Nodes:
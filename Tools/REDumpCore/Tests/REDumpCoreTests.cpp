@@ -0,0 +1,251 @@
+// Runs the dump parsers over the corpora in Tests/Corpus, malformed entries included.
+//   REDumpCoreTests <Path to Tests/Corpus>
+#include "REDumpCore.h"
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Counts failures instead of stopping, so one run reports every broken check
+#define RE_CHECK(Expr)                                                         \
+  do                                                                           \
+  {                                                                            \
+    if (!(Expr))                                                               \
+    {                                                                          \
+      std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #Expr); \
+      Failures++;                                                              \
+    }                                                                          \
+  } while (false)
+
+namespace
+{
+  int Failures = 0;
+
+  std::string CorpusDir;
+
+  std::string LoadCorpus(const char* Name)
+  {
+    const std::string Path = CorpusDir + "/" + Name;
+    std::string Data;
+    std::FILE* File = std::fopen(Path.c_str(), "rb");
+    if (!File)
+    {
+      std::fprintf(stderr, "Failed to read \"%s\"\n", Path.c_str());
+      Failures++;
+      return Data;
+    }
+    char Buffer[4096];
+    size_t Count = 0;
+    while ((Count = std::fread(Buffer, 1, sizeof(Buffer), File)) > 0)
+    {
+      Data.append(Buffer, Count);
+    }
+    std::fclose(File);
+    return Data;
+  }
+
+  bool Near(float A, float B)
+  {
+    return std::fabs(A - B) < 1e-5f;
+  }
+
+  void TestMaterials()
+  {
+    const std::string Text = LoadCorpus("MaterialsList.txt");
+    std::vector<REDumpCore::MaterialEntry> Entries;
+    std::vector<size_t> ErrorLines;
+    RE_CHECK(REDumpCore::ParseMaterials(Text, Entries, ErrorLines) == 11);
+    RE_CHECK(Entries.size() == 3);
+    RE_CHECK(ErrorLines == std::vector<size_t>({ 8 }));
+    if (Entries.size() != 3)
+    {
+      return;
+    }
+
+    const REDumpCore::MaterialEntry& Base = Entries[0];
+    RE_CHECK(Base.Name == "M_Base");
+    RE_CHECK(Base.ParentName.empty());
+    RE_CHECK(Base.TwoSided);
+    RE_CHECK(Base.Parameters.size() == 2);
+    if (Base.Parameters.size() == 2)
+    {
+      RE_CHECK(Base.Parameters[0].Type == REDumpCore::EParameterType::Texture);
+      RE_CHECK(Base.Parameters[0].Texture == "Textures/T_Base_D");
+      RE_CHECK(Base.Parameters[1].Type == REDumpCore::EParameterType::Scalar);
+      RE_CHECK(Near(Base.Parameters[1].Value[0], 0.5f));
+    }
+
+    const REDumpCore::MaterialEntry& Child = Entries[1];
+    RE_CHECK(Child.Name == "MI_Child");
+    RE_CHECK(Child.ParentName == "M_Base");
+    RE_CHECK(!Child.TwoSided);
+    RE_CHECK(Child.Parameters.size() == 3);
+    if (Child.Parameters.size() == 3)
+    {
+      RE_CHECK(Child.Parameters[0].Type == REDumpCore::EParameterType::TextureA);
+      RE_CHECK(Child.Parameters[1].Type == REDumpCore::EParameterType::Vector);
+      RE_CHECK(Near(Child.Parameters[1].Value[2], 0.25f) && Near(Child.Parameters[1].Value[3], 1.f));
+      RE_CHECK(Child.Parameters[2].Type == REDumpCore::EParameterType::Bool && Child.Parameters[2].Bool);
+    }
+
+    RE_CHECK(Entries[2].Name == "M_Second");
+  }
+
+  void TestTextures()
+  {
+    const std::string Text = LoadCorpus("Textures.txt");
+    std::vector<REDumpCore::TextureEntry> Entries;
+    std::vector<size_t> ErrorLines;
+    RE_CHECK(REDumpCore::ParseTextures(Text, Entries, ErrorLines) == 4);
+    RE_CHECK(Entries.size() == 2);
+    RE_CHECK(ErrorLines == std::vector<size_t>({ 1, 2 }));
+    if (Entries.size() != 2)
+    {
+      return;
+    }
+    RE_CHECK(Entries[0].Compression == "TC_Default");
+    RE_CHECK(Entries[0].SRGB && !Entries[0].IsDXT);
+    RE_CHECK(Entries[0].Name == "Textures/T_Base_D");
+    // CRLF is not a part of the value
+    RE_CHECK(Entries[0].Source == "C:/Export/T_Base_D.tga");
+    RE_CHECK(Entries[1].Name == "Textures/T_Mask");
+  }
+
+  void TestDefaultMaterials()
+  {
+    const std::string Text = LoadCorpus("DefaultMaterials.txt");
+    std::vector<REDumpCore::DefaultMaterialsEntry> Entries;
+    std::vector<size_t> ErrorLines;
+    RE_CHECK(REDumpCore::ParseDefaultMaterials(Text, Entries, ErrorLines) == 7);
+    RE_CHECK(Entries.size() == 2);
+    RE_CHECK(ErrorLines == std::vector<size_t>({ 0, 6 }));
+    if (Entries.size() != 2)
+    {
+      return;
+    }
+    RE_CHECK(Entries[0].Name == "Meshes/SM_Rock");
+    RE_CHECK(Entries[0].Materials == std::vector<std::string_view>({ "Materials/M_Rock", "None" }));
+    RE_CHECK(Entries[1].Name == "Meshes/SM_Tree");
+    RE_CHECK(Entries[1].Materials.size() == 2);
+  }
+
+  void TestSpeedTreeOverrides()
+  {
+    const std::string Text = LoadCorpus("SpeedTreeOverrides.txt");
+    std::vector<REDumpCore::SpeedTreeOverrideEntry> Entries;
+    std::vector<size_t> ErrorLines;
+    RE_CHECK(REDumpCore::ParseSpeedTreeOverrides(Text, Entries, ErrorLines) == 6);
+    RE_CHECK(Entries.size() == 2);
+    RE_CHECK(ErrorLines == std::vector<size_t>({ 3 }));
+    if (Entries.size() != 2)
+    {
+      return;
+    }
+    RE_CHECK(Entries[0].ActorName == "SpeedTreeActor_1");
+    RE_CHECK(Entries[0].Overrides.size() == 2);
+    if (Entries[0].Overrides.size() == 2)
+    {
+      RE_CHECK(Entries[0].Overrides[0].Slot == "Leaves" && Entries[0].Overrides[0].Material == "Materials/M_Leaves");
+      RE_CHECK(Entries[0].Overrides[1].Material == "None");
+    }
+    RE_CHECK(Entries[1].Overrides.size() == 1);
+  }
+
+  void TestCues()
+  {
+    {
+      const std::string Text = LoadCorpus("Good.cue");
+      REDumpCore::CueEntry Cue;
+      const char* Error = nullptr;
+      RE_CHECK(REDumpCore::ParseCue(Text, Cue, Error));
+      RE_CHECK(Cue.Path == "Sounds/Cues/C_Test");
+      RE_CHECK(Cue.Volume && Near(*Cue.Volume, 0.8f));
+      RE_CHECK(Cue.Pitch && Near(*Cue.Pitch, 1.1f));
+      RE_CHECK(Cue.MaxConcurrentPlayCount && *Cue.MaxConcurrentPlayCount == 4);
+      RE_CHECK(Cue.Nodes.size() == 3);
+      if (Cue.Nodes.size() == 3)
+      {
+        RE_CHECK(Cue.Nodes[0].Class == "SoundNodeRandom");
+        RE_CHECK(Cue.Nodes[0].Children && Cue.Nodes[0].Children->Indices == std::vector<int32_t>({ 1, 2 }));
+        RE_CHECK(Cue.Nodes[0].Properties.size() == 1);
+        RE_CHECK(Cue.Nodes[2].Properties.size() == 1 && Cue.Nodes[2].Properties[0].Value == "Sounds/Waves/W_B");
+      }
+    }
+    for (const char* Name : { "NoNodes.cue", "TwoNodeLists.cue", "NoPath.cue" })
+    {
+      const std::string Text = LoadCorpus(Name);
+      REDumpCore::CueEntry Cue;
+      const char* Error = nullptr;
+      const bool bParsed = REDumpCore::ParseCue(Text, Cue, Error);
+      RE_CHECK(!bParsed && Error);
+      if (bParsed)
+      {
+        std::fprintf(stderr, "%s parsed but it is malformed\n", Name);
+      }
+    }
+  }
+
+  // Every vector scanner this CPU supports must find the same positions as the scalar one, including matches in the tail
+  void TestSplitLines()
+  {
+    const std::string_view Text = "A\r\n\nB\n\r\nC";
+    std::vector<std::string_view> Lines;
+    REDumpCore::SplitLines(Text, Lines);
+    RE_CHECK(Lines == std::vector<std::string_view>({ "A", "B", "C" }));
+    Lines.clear();
+    REDumpCore::SplitLines(Text, Lines, false);
+    RE_CHECK(Lines == std::vector<std::string_view>({ "A", "", "B", "", "C" }));
+  }
+
+  void TestScanner(REDumpCore::EInstructionSet Set)
+  {
+    std::string Text;
+    for (int Idx = 0; Idx < 200; ++Idx)
+    {
+      Text += Idx % 7 ? 'a' : '\t';
+      Text += Idx % 13 ? "" : "\n ";
+      Text += Idx % 17 ? "" : "\nX";
+    }
+    for (size_t Begin = 0; Begin < 40; ++Begin)
+    {
+      for (size_t End = Begin; End <= Text.size(); End += 5)
+      {
+        const char* B = Text.data() + Begin;
+        const char* E = Text.data() + End;
+        REDumpCore::SetInstructionSet(REDumpCore::EInstructionSet::Scalar);
+        const char* ScalarChar = REDumpCore::FindChar(B, E, '\t');
+        const char* ScalarEntry = REDumpCore::FindEntryStart(B, E);
+        REDumpCore::SetInstructionSet(Set);
+        RE_CHECK(REDumpCore::FindChar(B, E, '\t') == ScalarChar);
+        RE_CHECK(REDumpCore::FindEntryStart(B, E) == ScalarEntry);
+      }
+    }
+    REDumpCore::SetForceScalar(false);
+  }
+}
+
+int main(int Argc, char** Argv)
+{
+  if (Argc != 2)
+  {
+    std::printf("Usage: REDumpCoreTests <Path to Tests/Corpus>\n");
+    return 1;
+  }
+  CorpusDir = Argv[1];
+  TestMaterials();
+  TestTextures();
+  TestDefaultMaterials();
+  TestSpeedTreeOverrides();
+  TestCues();
+  TestSplitLines();
+  for (REDumpCore::EInstructionSet Set : { REDumpCore::EInstructionSet::SSE2, REDumpCore::EInstructionSet::AVX2 })
+  {
+    if (Set <= REDumpCore::GetSupportedInstructionSet())
+    {
+      TestScanner(Set);
+    }
+  }
+  std::printf("%s, %d failed checks (%s scanner)\n", Failures ? "FAILED" : "OK", Failures, REDumpCore::GetInstructionSetName());
+  return Failures ? 1 : 0;
+}